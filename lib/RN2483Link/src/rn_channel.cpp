@@ -0,0 +1,106 @@
+#include "rn_channel.h"
+
+static const uint32_t frequencies[RN_CHANNEL_COUNT] = {
+  865700000UL,
+  866100000UL,
+  866500000UL,
+  866900000UL,
+  868100000UL, // RN_CHANNEL_UPLINK_RENDEZVOUS
+  868500000UL, // RN_CHANNEL_DOWNLINK_RENDEZVOUS
+  867300000UL,
+  867700000UL
+};
+
+uint32_t rn_channel_frequency(uint8_t channel)
+{
+  if (channel >= RN_CHANNEL_COUNT) {
+    return 0;
+  }
+  return frequencies[channel];
+}
+
+void rn_channel_plan_init(rn_channel_plan *plan)
+{
+  for (uint8_t i = 0; i < RN_CHANNEL_COUNT; ++i) {
+    plan->channels[i].samples = 0;
+    plan->channels[i].busy = 0;
+    plan->channels[i].snr = -128;
+    plan->channels[i].loss = 0;
+  }
+}
+
+void rn_channel_sample(rn_channel_plan *plan, uint8_t channel, bool busy, int8_t snr)
+{
+  if (channel >= RN_CHANNEL_COUNT) {
+    return;
+  }
+  rn_channel_stats *stats = &plan->channels[channel];
+
+  // Halve old counts before they overflow so later scans still matter
+  if (stats->samples == 0xFF) {
+    stats->samples /= 2;
+    stats->busy /= 2;
+  }
+  ++stats->samples;
+  if (busy) {
+    ++stats->busy;
+    if (snr > stats->snr) {
+      stats->snr = snr;
+    }
+  }
+}
+
+void rn_channel_record(rn_channel_plan *plan, uint8_t channel, bool delivered)
+{
+  if (channel >= RN_CHANNEL_COUNT) {
+    return;
+  }
+  // Exponential average with weight 1/8 per frame
+  uint8_t &loss = plan->channels[channel].loss;
+  if (delivered) {
+    loss -= loss >> 3;
+  }
+  else {
+    loss += (uint8_t)((0xFF - loss + 7) >> 3);
+  }
+}
+
+uint16_t rn_channel_score(const rn_channel_plan *plan, uint8_t channel)
+{
+  const rn_channel_stats *stats = &plan->channels[channel];
+  uint16_t score = stats->loss;
+
+  if (stats->samples > 0) {
+    // Occupancy 0-255, doubled since a busy channel also costs the peer
+    score += (uint16_t)(((uint32_t)stats->busy * 510) / stats->samples);
+  }
+  // A strong interferer is worse than one at the noise floor
+  if (stats->busy > 0 && stats->snr > -20) {
+    score += (uint16_t)(stats->snr + 20);
+  }
+  return score;
+}
+
+uint8_t rn_channel_pick(const rn_channel_plan *plan, uint8_t exclude)
+{
+  uint8_t best = RN_CHANNEL_NONE;
+  uint16_t best_score = 0xFFFF;
+
+  exclude |= RN_CHANNEL_BIT(RN_CHANNEL_UPLINK_RENDEZVOUS) | RN_CHANNEL_BIT(RN_CHANNEL_DOWNLINK_RENDEZVOUS);
+  for (uint8_t i = 0; i < RN_CHANNEL_COUNT; ++i) {
+    if (exclude & RN_CHANNEL_BIT(i)) {
+      continue;
+    }
+    uint16_t score = rn_channel_score(plan, i);
+    if (best == RN_CHANNEL_NONE || score < best_score) {
+      best = i;
+      best_score = score;
+    }
+  }
+  return best;
+}
+
+bool rn_channel_degraded(const rn_channel_plan *plan, uint8_t channel)
+{
+  return channel < RN_CHANNEL_COUNT && plan->channels[channel].loss >= RN_CHANNEL_HOP_LOSS;
+}
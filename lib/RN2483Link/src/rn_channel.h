@@ -0,0 +1,78 @@
+/*
+ * Runtime channel plan.
+ *
+ * The drone owns the plan. At startup it listens on every candidate for a
+ * few short "radio rx" windows and notes how often something else is on
+ * the air, then keeps a running loss estimate per channel while sessions
+ * are up. The cleanest two channels carry the two hops, and the choice is
+ * announced in the CONNECT/CONNECTED and RESUME/RESUMED exchange or with
+ * "HOP/<session>/<channel>".
+ *
+ * Handshakes always start on the fixed rendezvous channels, and a node
+ * whose session is not established listens there again. A peer that
+ * misses a hop ends up suspended, meets the drone on the rendezvous
+ * channel and resumes.
+ */
+#ifndef RN_CHANNEL_H
+#define RN_CHANNEL_H
+
+#include <stdint.h>
+
+// 400 kHz apart so the 250 kHz wide channels do not overlap, all in the 1% duty cycle bands
+#define RN_CHANNEL_COUNT 8
+#define RN_CHANNEL_NONE  0xFF
+
+#define RN_CHANNEL_UPLINK_RENDEZVOUS   4 // 868.1 MHz, transmitter <-> drone handshakes
+#define RN_CHANNEL_DOWNLINK_RENDEZVOUS 5 // 868.5 MHz, drone <-> receiver handshakes
+
+// Length of one scan window in symbols, 64 symbols at SF12/250 kHz is about one second
+#ifndef RN_CHANNEL_SCAN_WINDOW
+#define RN_CHANNEL_SCAN_WINDOW 64
+#endif
+#ifndef RN_CHANNEL_SCAN_SAMPLES
+#define RN_CHANNEL_SCAN_SAMPLES 2
+#endif
+
+// Loss estimate (0-255) above which the drone moves a hop to a backup channel
+#ifndef RN_CHANNEL_HOP_LOSS
+#define RN_CHANNEL_HOP_LOSS 128
+#endif
+
+struct rn_channel_stats {
+  uint8_t samples; // scan windows listened to
+  uint8_t busy;    // windows in which a frame was heard
+  int8_t snr;      // strongest foreign frame heard, -128 if none
+  uint8_t loss;    // running loss estimate, 0 = none, 255 = everything lost
+};
+
+struct rn_channel_plan {
+  rn_channel_stats channels[RN_CHANNEL_COUNT];
+};
+
+// Centre frequency of a channel in Hz, 0 for an unknown channel
+uint32_t rn_channel_frequency(uint8_t channel);
+
+void rn_channel_plan_init(rn_channel_plan *plan);
+
+// Result of one scan window
+void rn_channel_sample(rn_channel_plan *plan, uint8_t channel, bool busy, int8_t snr);
+
+// Outcome of a frame that expected an answer, feeds the loss estimate
+void rn_channel_record(rn_channel_plan *plan, uint8_t channel, bool delivered);
+
+// Lower is better
+uint16_t rn_channel_score(const rn_channel_plan *plan, uint8_t channel);
+
+// Bit of a channel in an exclusion mask, none for RN_CHANNEL_NONE
+#define RN_CHANNEL_BIT(channel) ((channel) < RN_CHANNEL_COUNT ? (uint8_t)(1U << (channel)) : (uint8_t)0)
+
+/*
+ * Cleanest channel not in the exclude mask. The rendezvous channels are
+ * never picked, a hop there would hear the other hop's handshakes.
+ */
+uint8_t rn_channel_pick(const rn_channel_plan *plan, uint8_t exclude);
+
+// True once the loss on a channel is high enough to be worth a hop
+bool rn_channel_degraded(const rn_channel_plan *plan, uint8_t channel);
+
+#endif
@@ -0,0 +1,228 @@
+#include "rn_fragment.h"
+
+#include <string.h>
+
+#if RN_FRAG_MAX_FRAGMENTS > 16
+#error "RN_FRAG_MAX_FRAGMENTS must fit the 16 bit ack bitmap"
+#endif
+
+uint8_t rn_frag_count(size_t len)
+{
+  if (len == 0 || len > RN_FRAG_MAX_MESSAGE) {
+    return 0;
+  }
+  return (uint8_t)((len + RN_FRAG_DATA - 1) / RN_FRAG_DATA);
+}
+
+uint16_t rn_frag_all(uint8_t total)
+{
+  if (total >= 16) {
+    return 0xFFFF;
+  }
+  return (uint16_t)((1U << total) - 1);
+}
+
+size_t rn_frag_build(uint8_t id, uint8_t index, bool ack_request,
+                     const uint8_t *msg, size_t len, uint8_t *frame)
+{
+  uint8_t total = rn_frag_count(len);
+  if (total == 0 || index >= total) {
+    return 0;
+  }
+
+  size_t offset = (size_t)index * RN_FRAG_DATA;
+  size_t chunk = len - offset < RN_FRAG_DATA ? len - offset : RN_FRAG_DATA;
+
+  frame[0] = 'F';
+  frame[1] = '/';
+  frame[2] = id;
+  frame[3] = ack_request ? (uint8_t)(index | RN_FRAG_ACK_REQUEST) : index;
+  frame[4] = total;
+  memcpy(frame + RN_FRAG_HEADER, msg + offset, chunk);
+  return RN_FRAG_HEADER + chunk;
+}
+
+static bool is_fragment(const uint8_t *frame, size_t len)
+{
+  return frame != NULL && len > RN_FRAG_HEADER && frame[0] == 'F' && frame[1] == '/';
+}
+
+bool rn_frag_ack_request(const uint8_t *frame, size_t len)
+{
+  return is_fragment(frame, len) && (frame[3] & RN_FRAG_ACK_REQUEST) != 0;
+}
+
+bool rn_frag_parse_ack(const uint8_t *frame, size_t len, uint8_t *id, uint16_t *received)
+{
+  if (frame == NULL || len != RN_FRAG_ACK_LEN || frame[0] != 'A' || frame[1] != '/') {
+    return false;
+  }
+  *id = frame[2];
+  *received = (uint16_t)(frame[3] | (frame[4] << 8));
+  return true;
+}
+
+// Sends what the peer is missing, or only the request again if the last round went unanswered
+static void start_round(rn_blob_sender *b)
+{
+  b->last = b->total - 1;
+  while (b->acked & (1U << b->last)) {
+    --b->last;
+  }
+  b->next = b->answered ? 0 : b->last;
+  b->waiting = false;
+}
+
+static rn_blob_result end_round(rn_blob_sender *b, bool answered)
+{
+  if (b->acked == rn_frag_all(b->total)) {
+    b->total = 0;
+    return RN_BLOB_DONE;
+  }
+  if (++b->round >= RN_FRAG_MAX_ROUNDS) {
+    b->total = 0;
+    return RN_BLOB_FAILED;
+  }
+  b->answered = answered;
+  start_round(b);
+  return RN_BLOB_SENDING;
+}
+
+bool rn_blob_begin(rn_blob_sender *b, uint8_t id, size_t len)
+{
+  b->total = rn_frag_count(len);
+  if (b->total == 0) {
+    return false;
+  }
+  b->id = id;
+  b->round = 0;
+  b->acked = 0;
+  b->answered = true;
+  start_round(b);
+  return true;
+}
+
+bool rn_blob_busy(const rn_blob_sender *b)
+{
+  return b->total != 0;
+}
+
+size_t rn_blob_next(rn_blob_sender *b, const uint8_t *msg, size_t len, uint8_t *frame)
+{
+  if (b->total == 0 || b->waiting) {
+    return 0;
+  }
+  while (b->acked & (1U << b->next)) {
+    ++b->next;
+  }
+  uint8_t index = b->next++;
+  b->waiting = index == b->last;
+  return rn_frag_build(b->id, index, b->waiting, msg, len, frame);
+}
+
+rn_blob_result rn_blob_ack(rn_blob_sender *b, const uint8_t *frame, size_t len)
+{
+  uint8_t id = 0;
+  uint16_t received = 0;
+  if (b->total == 0 || !rn_frag_parse_ack(frame, len, &id, &received) || id != b->id) {
+    return RN_BLOB_SENDING;
+  }
+  b->acked |= received & rn_frag_all(b->total);
+  // An ack for an earlier round only spares fragments, the round goes on
+  if (!b->waiting && b->acked != rn_frag_all(b->total)) {
+    while (b->acked & (1U << b->last)) {
+      --b->last;
+    }
+    if (b->next > b->last) {
+      b->next = b->last;
+    }
+    return RN_BLOB_SENDING;
+  }
+  return end_round(b, true);
+}
+
+rn_blob_result rn_blob_lost(rn_blob_sender *b)
+{
+  if (b->total == 0) {
+    return RN_BLOB_FAILED;
+  }
+  return end_round(b, false);
+}
+
+void rn_reassembly_init(rn_reassembly *r)
+{
+  r->id = 0;
+  r->total = 0;
+  r->received = 0;
+  r->length = 0;
+  r->since = 0;
+}
+
+rn_frag_result rn_reassembly_add(rn_reassembly *r, const uint8_t *frame, size_t len, uint32_t now)
+{
+  if (!is_fragment(frame, len) || len > RN_FRAG_FRAME_MAX) {
+    return RN_FRAG_INVALID;
+  }
+
+  uint8_t id = frame[2];
+  uint8_t index = frame[3] & ~RN_FRAG_ACK_REQUEST;
+  uint8_t total = frame[4];
+  size_t chunk = len - RN_FRAG_HEADER;
+
+  // Every fragment but the last is full, the last one carries the remainder
+  if (total == 0 || total > RN_FRAG_MAX_FRAGMENTS || index >= total
+      || (index + 1 < total && chunk != RN_FRAG_DATA)) {
+    return RN_FRAG_INVALID;
+  }
+
+  rn_reassembly_poll(r, now);
+  if (r->total == 0 || id != r->id || total != r->total) {
+    r->id = id;
+    r->total = total;
+    r->received = 0;
+    r->length = 0;
+  }
+
+  uint16_t bit = (uint16_t)(1U << index);
+  r->since = now;
+  if (r->received & bit) {
+    return RN_FRAG_DUPLICATE;
+  }
+
+  memcpy(r->data + (size_t)index * RN_FRAG_DATA, frame + RN_FRAG_HEADER, chunk);
+  r->received |= bit;
+  if (index + 1 == total) {
+    r->length = (uint16_t)(index * RN_FRAG_DATA + chunk);
+  }
+  return rn_reassembly_complete(r) ? RN_FRAG_COMPLETE : RN_FRAG_PARTIAL;
+}
+
+void rn_reassembly_poll(rn_reassembly *r, uint32_t now)
+{
+  // A complete message stays a while so repeated fragments can still be
+  // acked, then goes too, or a sender restarted with the same id would
+  // have its new message acked as a duplicate of the old one
+  if (r->total != 0 && now - r->since >= RN_FRAG_TIMEOUT) {
+    rn_reassembly_init(r);
+  }
+}
+
+bool rn_reassembly_complete(const rn_reassembly *r)
+{
+  return r->total != 0 && r->received == rn_frag_all(r->total);
+}
+
+bool rn_reassembly_holds(const rn_reassembly *r, const uint8_t *frame, size_t len)
+{
+  return is_fragment(frame, len) && r->total != 0 && frame[2] == r->id && frame[4] == r->total;
+}
+
+size_t rn_reassembly_ack(const rn_reassembly *r, uint8_t *frame)
+{
+  frame[0] = 'A';
+  frame[1] = '/';
+  frame[2] = r->id;
+  frame[3] = (uint8_t)(r->received & 0xFF);
+  frame[4] = (uint8_t)(r->received >> 8);
+  return RN_FRAG_ACK_LEN;
+}
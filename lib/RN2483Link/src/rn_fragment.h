@@ -0,0 +1,132 @@
+/*
+ * Fragmentation of messages too large for one "radio tx".
+ *
+ * A fragment frame is "F/" followed by three binary header bytes (message
+ * id, index, fragment count) and up to RN_FRAG_DATA bytes of data. The
+ * sender marks the last fragment of each round with RN_FRAG_ACK_REQUEST,
+ * and the receiver answers with "A/" + message id + a 16 bit bitmap of the
+ * fragments it holds (low byte first). The sender then repeats only the
+ * fragments missing from the bitmap, so a lost fragment costs one
+ * fragment of airtime. If no ack comes back the sender repeats only the
+ * fragment carrying the request, a lost request or ack costs one fragment
+ * as well.
+ *
+ * The sender side is rn_blob_*: it hands out one fragment at a time, so the
+ * node can send and receive other frames between any two of them.
+ *
+ * The reassembly buffer is a fixed array, one message at a time; a
+ * fragment of a new message replaces an unfinished one. Senders start
+ * their message ids at a random value, so a restarted sender does not
+ * reuse the id of the message the peer still holds.
+ */
+#ifndef RN_FRAGMENT_H
+#define RN_FRAGMENT_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifndef RN_FRAG_DATA
+#define RN_FRAG_DATA 48           // data bytes per fragment
+#endif
+#ifndef RN_FRAG_MAX_FRAGMENTS
+#define RN_FRAG_MAX_FRAGMENTS 16  // at most 16, the ack bitmap is 16 bits
+#endif
+#ifndef RN_FRAG_TIMEOUT
+#define RN_FRAG_TIMEOUT 60000UL   // ms without a fragment before a partial message is dropped
+#endif
+#ifndef RN_FRAG_MAX_ROUNDS
+#define RN_FRAG_MAX_ROUNDS 4      // send rounds before the sender gives up
+#endif
+
+#define RN_FRAG_HEADER      5
+#define RN_FRAG_FRAME_MAX   (RN_FRAG_HEADER + RN_FRAG_DATA)
+#define RN_FRAG_ACK_LEN     5
+#define RN_FRAG_MAX_MESSAGE (RN_FRAG_MAX_FRAGMENTS * RN_FRAG_DATA)
+#define RN_FRAG_ACK_REQUEST 0x80  // set in the index byte
+
+enum rn_frag_result {
+  RN_FRAG_INVALID,   // not a well formed fragment
+  RN_FRAG_PARTIAL,   // stored, message not complete yet
+  RN_FRAG_DUPLICATE, // already had it
+  RN_FRAG_COMPLETE   // this fragment completed the message, reported once
+};
+
+enum rn_blob_result {
+  RN_BLOB_SENDING,   // more fragments to send or an ack to wait for
+  RN_BLOB_DONE,      // every fragment acknowledged
+  RN_BLOB_FAILED     // RN_FRAG_MAX_ROUNDS rounds without getting everything across
+};
+
+struct rn_blob_sender {
+  uint8_t id;
+  uint8_t total;      // 0 while idle
+  uint8_t next;       // next fragment of the round
+  uint8_t last;       // the round's last fragment, it asks for the ack
+  uint8_t round;
+  bool answered;      // the previous round got its ack
+  bool waiting;       // the round is out, its ack is due
+  uint16_t acked;     // bitmap of fragments the peer holds
+};
+
+struct rn_reassembly {
+  uint8_t id;
+  uint8_t total;      // 0 while empty
+  uint16_t received;  // bitmap of stored fragments
+  uint16_t length;    // message length once the last fragment is in
+  uint32_t since;     // millis() of the last stored fragment
+  uint8_t data[RN_FRAG_MAX_MESSAGE];
+};
+
+// Fragments needed for a message, 0 if it does not fit RN_FRAG_MAX_MESSAGE
+uint8_t rn_frag_count(size_t len);
+
+// Bitmap with a bit set for each of total fragments
+uint16_t rn_frag_all(uint8_t total);
+
+/*
+ * Builds fragment index of msg into frame, which must hold
+ * RN_FRAG_FRAME_MAX bytes. Returns the frame length, 0 on bad arguments.
+ */
+size_t rn_frag_build(uint8_t id, uint8_t index, bool ack_request,
+                     const uint8_t *msg, size_t len, uint8_t *frame);
+
+// True if the frame is a fragment that asks for an ack
+bool rn_frag_ack_request(const uint8_t *frame, size_t len);
+
+// Reads an ack frame, false if it is not one
+bool rn_frag_parse_ack(const uint8_t *frame, size_t len, uint8_t *id, uint16_t *received);
+
+// Starts sending a message of len bytes as id, false if it is empty or too large
+bool rn_blob_begin(rn_blob_sender *b, uint8_t id, size_t len);
+
+bool rn_blob_busy(const rn_blob_sender *b);
+
+/*
+ * Builds the next fragment of the round from msg, the message passed to
+ * rn_blob_begin(). Returns the frame length, 0 if the round is out and its
+ * ack is due.
+ */
+size_t rn_blob_next(rn_blob_sender *b, const uint8_t *msg, size_t len, uint8_t *frame);
+
+// Feeds a received frame, anything but an ack for this blob is ignored
+rn_blob_result rn_blob_ack(rn_blob_sender *b, const uint8_t *frame, size_t len);
+
+// No ack came for the round, the next one only repeats the request
+rn_blob_result rn_blob_lost(rn_blob_sender *b);
+
+void rn_reassembly_init(rn_reassembly *r);
+
+rn_frag_result rn_reassembly_add(rn_reassembly *r, const uint8_t *frame, size_t len, uint32_t now);
+
+// Drops a message, partial or complete, that has not seen a fragment for RN_FRAG_TIMEOUT
+void rn_reassembly_poll(rn_reassembly *r, uint32_t now);
+
+bool rn_reassembly_complete(const rn_reassembly *r);
+
+// True if the frame is a fragment of the message r holds
+bool rn_reassembly_holds(const rn_reassembly *r, const uint8_t *frame, size_t len);
+
+// Writes the ack for the current message into frame (RN_FRAG_ACK_LEN bytes)
+size_t rn_reassembly_ack(const rn_reassembly *r, uint8_t *frame);
+
+#endif
@@ -0,0 +1,193 @@
+#include "rn_frame.h"
+
+#include <string.h>
+
+static bool is_space(char c)
+{
+  return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+// Both codec tables live in flash on the AVR, a lookup costs one lpm
+#ifdef __AVR__
+#include <avr/pgmspace.h>
+#define TABLE_BYTE(table, index) pgm_read_byte(&(table)[index])
+#else
+#define PROGMEM
+#define TABLE_BYTE(table, index) ((table)[index])
+#endif
+
+#define NO_DIGIT 0xFF
+
+static const char hex_digits[16] PROGMEM = {
+  '0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'A', 'B', 'C', 'D', 'E', 'F'
+};
+
+// Value of the characters '0' to 'f', indexed by c - '0'
+static const uint8_t hex_values['f' - '0' + 1] PROGMEM = {
+  0, 1, 2, 3, 4, 5, 6, 7, 8, 9,                                  // 0-9
+  NO_DIGIT, NO_DIGIT, NO_DIGIT, NO_DIGIT, NO_DIGIT, NO_DIGIT, NO_DIGIT, // :;<=>?@
+  10, 11, 12, 13, 14, 15,                                        // A-F
+  NO_DIGIT, NO_DIGIT, NO_DIGIT, NO_DIGIT, NO_DIGIT, NO_DIGIT, NO_DIGIT, NO_DIGIT, // G-N
+  NO_DIGIT, NO_DIGIT, NO_DIGIT, NO_DIGIT, NO_DIGIT, NO_DIGIT, NO_DIGIT, NO_DIGIT, // O-V
+  NO_DIGIT, NO_DIGIT, NO_DIGIT, NO_DIGIT, NO_DIGIT, NO_DIGIT, NO_DIGIT, NO_DIGIT, // W-^
+  NO_DIGIT, NO_DIGIT,                                            // _`
+  10, 11, 12, 13, 14, 15                                         // a-f
+};
+
+static uint8_t hex_value(char c)
+{
+  uint8_t index = (uint8_t)(c - '0');
+  return index < sizeof(hex_values) ? TABLE_BYTE(hex_values, index) : NO_DIGIT;
+}
+
+static bool token_equals(const char *token, size_t len, const char *word)
+{
+  return strlen(word) == len && memcmp(token, word, len) == 0;
+}
+
+rn_line_type rn_parse_line(const char *line, size_t len,
+                           uint8_t *payload, size_t capacity, size_t *payload_len)
+{
+  *payload_len = 0;
+  if (line == NULL) {
+    return RN_LINE_EMPTY;
+  }
+
+  // Strip whitespace around the line, the module ends everything with \r\n
+  size_t begin = 0;
+  while (begin < len && is_space(line[begin])) {
+    ++begin;
+  }
+  while (len > begin && is_space(line[len - 1])) {
+    --len;
+  }
+  if (begin == len) {
+    return RN_LINE_EMPTY;
+  }
+
+  // The keyword ends at the first space
+  size_t word_end = begin;
+  while (word_end < len && !is_space(line[word_end])) {
+    ++word_end;
+  }
+  const char *word = line + begin;
+  size_t word_len = word_end - begin;
+  bool has_argument = word_end != len;
+
+  if (token_equals(word, word_len, "radio_rx")) {
+    // The module separates the hex with two spaces, accept any amount
+    size_t hex = word_end;
+    while (hex < len && is_space(line[hex])) {
+      ++hex;
+    }
+    size_t digits = len - hex;
+    if (digits == 0 || digits / 2 > capacity || !rn_hex_decode(line + hex, digits, payload)) {
+      return RN_LINE_MALFORMED;
+    }
+    *payload_len = digits / 2;
+    return RN_LINE_RADIO_RX;
+  }
+
+  if (has_argument) {
+    return RN_LINE_OTHER;
+  }
+  if (token_equals(word, word_len, "ok")) return RN_LINE_OK;
+  if (token_equals(word, word_len, "radio_tx_ok")) return RN_LINE_RADIO_TX_OK;
+  if (token_equals(word, word_len, "radio_err")) return RN_LINE_RADIO_ERR;
+  if (token_equals(word, word_len, "busy")) return RN_LINE_BUSY;
+  if (token_equals(word, word_len, "invalid_param")) return RN_LINE_INVALID;
+  return RN_LINE_OTHER;
+}
+
+rn_msg_type rn_classify(const uint8_t *msg, size_t len)
+{
+  if (msg == NULL || len == 0) {
+    return RN_MSG_NONE;
+  }
+
+  const char *text = (const char *)msg;
+  size_t token_len = 0;
+  while (token_len < len && text[token_len] != '/') {
+    ++token_len;
+  }
+
+  if (token_equals(text, token_len, "CONNECT")) return RN_MSG_CONNECT;
+  if (token_equals(text, token_len, "CONNECTED")) return RN_MSG_CONNECTED;
+  if (token_equals(text, token_len, "RESUME")) return RN_MSG_RESUME;
+  if (token_equals(text, token_len, "RESUMED")) return RN_MSG_RESUMED;
+  if (token_equals(text, token_len, "REJECT")) return RN_MSG_REJECT;
+  if (token_equals(text, token_len, "HOP")) return RN_MSG_HOP;
+  if (token_equals(text, token_len, "DEFER")) return RN_MSG_DEFER;
+  if (token_equals(text, token_len, "START")) return RN_MSG_START;
+  if (token_equals(text, token_len, "END")) return RN_MSG_END;
+
+  // Binary frames, the header check is left to rn_fragment
+  if (token_equals(text, token_len, "F") && token_len < len) return RN_MSG_FRAGMENT;
+  if (token_equals(text, token_len, "A") && token_len < len) return RN_MSG_FRAG_ACK;
+
+  // A packet needs its sequence number, a bare "P" or "P/x" is noise
+  if (token_equals(text, token_len, "P") && token_len + 1 < len
+      && text[token_len + 1] >= '0' && text[token_len + 1] <= '9') {
+    return RN_MSG_PACKET;
+  }
+  return RN_MSG_TEXT;
+}
+
+bool rn_field_uint(const uint8_t *msg, size_t len, uint8_t index, uint32_t *value)
+{
+  if (msg == NULL) {
+    return false;
+  }
+
+  size_t pos = 0;
+  while (index > 0 && pos < len) {
+    if (msg[pos] == '/') {
+      --index;
+    }
+    ++pos;
+  }
+  if (index > 0 || pos >= len || msg[pos] < '0' || msg[pos] > '9') {
+    return false;
+  }
+
+  uint32_t result = 0;
+  while (pos < len && msg[pos] >= '0' && msg[pos] <= '9') {
+    uint32_t digit = msg[pos] - '0';
+    if (result > (0xFFFFFFFFUL - digit) / 10) {
+      return false;
+    }
+    result = result * 10 + digit;
+    ++pos;
+  }
+  *value = result;
+  return true;
+}
+
+size_t rn_hex_encode(const uint8_t *in, size_t len, char *out)
+{
+  // Back to front, byte i is read before digits 2i and 2i + 1 overwrite it
+  out[2 * len] = '\0';
+  for (size_t i = len; i-- > 0; ) {
+    uint8_t byte = in[i];
+    out[2 * i + 1] = TABLE_BYTE(hex_digits, byte & 0x0F);
+    out[2 * i] = TABLE_BYTE(hex_digits, byte >> 4);
+  }
+  return 2 * len;
+}
+
+bool rn_hex_decode(const char *hex, size_t digits, uint8_t *out)
+{
+  if (digits % 2 != 0) {
+    return false;
+  }
+  // Front to back, byte i is written after digits 2i and 2i + 1 are read
+  for (size_t i = 0; i < digits; i += 2) {
+    uint8_t high = hex_value(hex[i]);
+    uint8_t low = hex_value(hex[i + 1]);
+    if ((high | low) > 0x0F) {
+      return false;
+    }
+    out[i / 2] = (uint8_t)((high << 4) | low);
+  }
+  return true;
+}
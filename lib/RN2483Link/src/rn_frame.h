@@ -0,0 +1,101 @@
+/*
+ * Parsing of the lines the RN2483 prints on its UART and of the messages
+ * the transmitter, drone and receiver exchange inside "radio tx" payloads.
+ *
+ * Nothing in here uses Arduino APIs, so the same code runs on the boards
+ * and on a PC. Every function accepts any byte sequence: truncated lines,
+ * odd length hex, garbage from a wedged UART or a packet that happens to
+ * contain the word "CONNECT" are classified, never trusted.
+ */
+#ifndef RN_FRAME_H
+#define RN_FRAME_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Largest payload the RN2483 accepts in one "radio tx" in LoRa mode
+#define RN_MAX_PAYLOAD 255
+
+// snprintf() whose format string stays in flash on the AVR
+#ifdef __AVR__
+#include <avr/pgmspace.h>
+#include <stdio.h>
+#define RN_SNPRINTF(buf, capacity, format, ...) snprintf_P(buf, capacity, PSTR(format), __VA_ARGS__)
+#else
+#include <stdio.h>
+#define RN_SNPRINTF(buf, capacity, format, ...) snprintf(buf, capacity, format, __VA_ARGS__)
+#endif
+
+// What a single line from the module was
+enum rn_line_type {
+  RN_LINE_EMPTY,       // nothing but whitespace
+  RN_LINE_OK,          // "ok", command accepted
+  RN_LINE_RADIO_RX,    // "radio_rx  <hex>" with a valid payload
+  RN_LINE_RADIO_TX_OK, // "radio_tx_ok"
+  RN_LINE_RADIO_ERR,   // "radio_err", rx window or radio watchdog expired
+  RN_LINE_BUSY,        // "busy"
+  RN_LINE_INVALID,     // "invalid_param"
+  RN_LINE_MALFORMED,   // "radio_rx" with an empty, odd, oversized or non-hex payload
+  RN_LINE_OTHER        // anything else (sysver, hweui, startup banner...)
+};
+
+// What a decoded payload asks the node to do
+enum rn_msg_type {
+  RN_MSG_NONE,      // empty payload, nothing was received
+  RN_MSG_CONNECT,   // "CONNECT/<session>"
+  RN_MSG_CONNECTED, // "CONNECTED/<session>"
+  RN_MSG_RESUME,    // "RESUME/<session>/<sequence>"
+  RN_MSG_RESUMED,   // "RESUMED/<session>/<sequence>"
+  RN_MSG_REJECT,    // "REJECT/<session>", the session to resume is unknown
+  RN_MSG_HOP,       // "HOP/<session>/<channel>"
+  RN_MSG_DEFER,     // "DEFER/<seconds>", the drone's budget held the burst back
+  RN_MSG_START,     // "START", a packet burst follows
+  RN_MSG_PACKET,    // "P/<number>..."
+  RN_MSG_END,       // "END", the burst is over
+  RN_MSG_FRAGMENT,  // "F/" + binary fragment, see rn_fragment.h
+  RN_MSG_FRAG_ACK,  // "A/" + binary fragment ack
+  RN_MSG_TEXT       // anything else, only for logging
+};
+
+/*
+ * Parses one line read from the module. Trailing "\r\n" is allowed.
+ * For RN_LINE_RADIO_RX the payload is hex decoded into payload (at most
+ * capacity bytes) and its length is stored in payload_len. For every other
+ * result payload_len is set to 0. payload may point at line itself, the
+ * hex is then decoded in place.
+ */
+rn_line_type rn_parse_line(const char *line, size_t len,
+                           uint8_t *payload, size_t capacity, size_t *payload_len);
+
+/*
+ * Classifies a decoded payload by its first '/' separated token. Tokens
+ * must match exactly, so "P/3,CONNECT" is a packet and "CONNECTED" is not
+ * a connection request.
+ */
+rn_msg_type rn_classify(const uint8_t *msg, size_t len);
+
+/*
+ * Reads the unsigned number at the start of field number index of a
+ * message, fields being separated by '/'. Field 0 is the message token,
+ * so for "RESUME/7/42" field 1 is 7 and field 2 is 42. The number ends at
+ * the first non-digit, which lets "P/12,BS:-3" yield 12. Returns false if
+ * the field is missing, does not start with a digit or overflows.
+ */
+bool rn_field_uint(const uint8_t *msg, size_t len, uint8_t index, uint32_t *value);
+
+/*
+ * Hex encodes len bytes into out for "radio tx". out must hold 2 * len + 1
+ * characters; the result is NUL terminated. Returns the number of digits.
+ * out may be the same buffer as in, it is filled from the back so the
+ * bytes are encoded in place.
+ */
+size_t rn_hex_encode(const uint8_t *in, size_t len, char *out);
+
+/*
+ * Decodes digits hex characters (either case) into digits / 2 bytes.
+ * out may be the same buffer as hex. Returns false on an odd count or a
+ * non-hex character, out is then partly written.
+ */
+bool rn_hex_decode(const char *hex, size_t digits, uint8_t *out);
+
+#endif
@@ -0,0 +1,272 @@
+#ifdef ARDUINO
+
+#include "rn_node.h"
+
+void Node::start(uint8_t channel, uint16_t watchdog_ms, unsigned long serial_baud)
+{
+  //output LED pin
+  pinMode(STATUS_LED_RECEIVING, OUTPUT);
+  pinMode(STATUS_LED_SENDING, OUTPUT);
+  pinMode(STATUS_LED_CONNECTED, OUTPUT);
+
+  // Open serial communications and wait for port to open:
+  Serial.begin(serial_baud); //serial port to computer
+  Serial.println(F("Startup"));
+
+  supervisor = rn_supervisor_begin();
+  radio.begin(channel, watchdog_ms, supervisor);
+  rn_txq_init(&txq, millis());
+  status_led_receiving(false);
+  randomSeed(analogRead(A0));
+  // After a reset the peer may still hold a finished blob under a low id
+  blob_id = (uint8_t)random(0, 0x100);
+}
+
+void Node::status_led_connected(bool ledStatus)
+{
+  digitalWrite(STATUS_LED_CONNECTED, ledStatus ? HIGH : LOW);
+  Serial.println(ledStatus ? F("Connected") : F("Not connected"));
+}
+
+void Node::status_led_sending(bool ledStatus)
+{
+  digitalWrite(STATUS_LED_SENDING, ledStatus ? HIGH : LOW);
+  Serial.println(ledStatus ? F("Sending") : F("Not sending"));
+}
+
+void Node::status_led_receiving(bool ledStatus)
+{
+  // The drone's receiving LED is wired to VCC and lights on LOW
+#ifdef STATUS_LED_RECEIVING_ACTIVE_LOW
+  digitalWrite(STATUS_LED_RECEIVING, ledStatus ? LOW : HIGH);
+#else
+  digitalWrite(STATUS_LED_RECEIVING, ledStatus ? HIGH : LOW);
+#endif
+  Serial.println(ledStatus ? F("Receiving") : F("Not receiving"));
+}
+
+rn_msg_type Node::message_type(const String &msg)
+{
+  return rn_classify((const uint8_t *)msg.c_str(), msg.length());
+}
+
+bool Node::queue(rn_tx_class cls, const uint8_t *data, size_t len)
+{
+  if (!rn_txq_push(&txq, cls, data, len, millis())){
+    Serial.println(String(F("TX queue full, class ")) + String((int)cls) + F(" frame dropped"));
+    return false;
+  }
+  return true;
+}
+
+bool Node::queue(rn_tx_class cls, const String &msg)
+{
+  return queue(cls, (const uint8_t *)msg.c_str(), msg.length());
+}
+
+void Node::flush()
+{
+  int index;
+  while ((index = rn_txq_next(&txq, millis())) >= 0){
+    unsigned long idle = millis() - radio.idle_since();
+    if (idle < RN_TXQ_GAP){
+      // Pick again afterwards, a frame may have gone stale meanwhile
+      rn_supervisor_delay(RN_TXQ_GAP - idle);
+      continue;
+    }
+    size_t len = 0;
+    const uint8_t *frame = rn_txq_frame(&txq, (uint8_t)index, &len);
+    radio.send_frame(frame, len);
+    rn_txq_sent(&txq, (uint8_t)index, millis());
+  }
+  if (txq.count > 0){
+    Serial.println(String(F("Duty cycle budget: ")) + String((int)txq.count) + F(" frames held back"));
+  }
+}
+
+void Node::send(rn_tx_class cls, const String &msg)
+{
+  queue(cls, msg);
+  flush();
+}
+
+bool Node::send_burst(const String &packet)
+{
+  if (!rn_txq_affordable(&txq, RN_TX_TELEMETRY, burst_airtime(packet), millis())){
+    Serial.println(F("Duty cycle budget exhausted, burst skipped"));
+    return false;
+  }
+  // A burst goes out whole or not at all
+  if (!queue(RN_TX_TELEMETRY, START_MESSAGE) || !queue(RN_TX_TELEMETRY, packet)
+      || !queue(RN_TX_TELEMETRY, END_MESSAGE)){
+    rn_txq_drop(&txq, RN_TX_TELEMETRY);
+    return false;
+  }
+  flush();
+  return true;
+}
+
+uint32_t Node::burst_airtime(const String &packet)
+{
+  return rn_airtime(strlen(START_MESSAGE)) + rn_airtime(packet.length()) + rn_airtime(strlen(END_MESSAGE));
+}
+
+void Node::send_session_action(const rn_session *session, rn_session_action action)
+{
+  char msg[24];
+  size_t len = rn_session_format(session, action, msg, sizeof(msg));
+  if (len > 0){
+    queue(RN_TX_CONTROL, (const uint8_t *)msg, len);
+    flush();
+  }
+}
+
+void Node::tune(const rn_session *session, uint8_t rendezvous)
+{
+  uint8_t channel = rn_session_channel(session, rendezvous);
+  if (channel != radio.channel()){
+    // What the budget held back was meant for the peer on the old channel
+    for (uint8_t cls = 0; cls < RN_TX_CLASS_COUNT; ++cls){
+      rn_txq_drop(&txq, (rn_tx_class)cls);
+    }
+  }
+  radio.tune(channel);
+}
+
+uint16_t Node::new_session_id()
+{
+  return (uint16_t)random(1, 0x10000);
+}
+
+bool Node::connection_request(rn_session *session, uint8_t rendezvous, uint8_t channel)
+{
+  int connection_tries = 1;
+
+  while(connection_tries < 6) {
+    Serial.println(String(F("Trying to connect ")) + String(connection_tries) + F(" times."));
+    rn_session_poll(session, millis());
+    tune(session, rendezvous);
+    rn_session_action action = rn_session_event(session, RN_EV_OPEN, new_session_id(), millis());
+    if (channel != RN_CHANNEL_NONE){
+      session->channel = channel;
+    }
+    send_session_action(session, action);
+
+    String resp = radio.receive();
+    rn_session_message(session, (const uint8_t *)resp.c_str(), resp.length(), millis());
+    if (rn_session_established(session)){
+      Serial.println(String(F("Connection created! Session: ")) + String(session->id) + F(", Attempts: ")+String(triedConnIndex));
+      return true;
+    }
+    ++ connection_tries;
+  }
+  ++triedConnIndex;
+
+  return false;
+}
+
+bool Node::receive_burst(message_hook message, const char *tag, String *packet)
+{
+  while(true){
+    String tempS = radio.receive();
+    String snr = String(radio.snr());
+    rn_msg_type type = (this->*message)(tempS, true);
+    if (type == RN_MSG_PACKET)
+    {
+      *packet = tempS + ",BS:" + snr + telemetry(tag);
+      Serial.println(String(F("BS Saved: ")) + *packet);
+    }
+
+    if (type == RN_MSG_END)
+    {
+      Serial.println(tempS);
+      Serial.println(F("Packets received!"));
+      return true;
+    }
+    if (type == RN_MSG_CONNECT || type == RN_MSG_RESUME || type == RN_MSG_NONE)
+    {
+      Serial.println(F("Failed receiving packages."));
+      return false;
+    }
+  }
+}
+
+String Node::telemetry(const char *tag)
+{
+  char field[40];
+  if (rn_supervisor_format(supervisor, tag, field, sizeof(field)) == 0){
+    return "";
+  }
+  return "," + String(field);
+}
+
+bool Node::start_blob(const uint8_t *data, size_t len)
+{
+  if (rn_blob_busy(&blob)){
+    return false;
+  }
+  if (++blob_id == 0){
+    blob_id = 1;
+  }
+  blob_data = data;
+  blob_len = len;
+  return rn_blob_begin(&blob, blob_id, len);
+}
+
+rn_blob_result Node::blob_step(String *heard)
+{
+  uint8_t out[RN_FRAG_FRAME_MAX];
+  int8_t snr = 0;
+  *heard = "";
+  // Control goes first, then the fragment only once the budget can take it
+  flush();
+  if (!rn_txq_affordable(&txq, RN_TX_BULK, rn_airtime(RN_FRAG_FRAME_MAX), millis())){
+    return RN_BLOB_SENDING;
+  }
+  size_t len = rn_blob_next(&blob, blob_data, blob_len, out);
+  if (len == 0){
+    return RN_BLOB_SENDING;
+  }
+  queue(RN_TX_BULK, out, len);
+  flush();
+
+  if (blob.waiting){
+    *heard = radio.receive();
+  }
+  else if (radio.listen(NODE_BLOB_SLOT, &snr)){
+    *heard = String((const char *)radio.frame());
+  }
+
+  rn_blob_result result = RN_BLOB_SENDING;
+  if (message_type(*heard) == RN_MSG_FRAG_ACK){
+    result = rn_blob_ack(&blob, radio.frame(), radio.frame_len());
+    *heard = "";
+  }
+  // Nothing, or not our ack, where the round's ack was due
+  if (rn_blob_busy(&blob) && blob.waiting){
+    result = rn_blob_lost(&blob);
+  }
+  if (result == RN_BLOB_DONE){
+    Serial.println(String(F("Blob ")) + String(blob.id) + F(" sent in ") + String(blob.round + 1) + F(" rounds"));
+  }
+  else if (result == RN_BLOB_FAILED){
+    Serial.println(String(F("Blob ")) + String(blob.id) + F(" not acknowledged"));
+  }
+  return result;
+}
+
+rn_frag_result Node::receive_fragment(rn_reassembly *reassembly)
+{
+  rn_frag_result result = rn_reassembly_add(reassembly, radio.frame(), radio.frame_len(), millis());
+  if (rn_frag_ack_request(radio.frame(), radio.frame_len())){
+    uint8_t ack[RN_FRAG_ACK_LEN];
+    queue(RN_TX_CONTROL, ack, rn_reassembly_ack(reassembly, ack));
+    flush();
+  }
+  if (result == RN_FRAG_COMPLETE){
+    Serial.println(String(F("Blob ")) + String(reassembly->id) + F(" received: ") + String(reassembly->length) + F(" bytes"));
+  }
+  return result;
+}
+
+#endif
@@ -0,0 +1,145 @@
+/*
+ * Parts every node role shares: the radio, the status LEDs, the transmit
+ * queue, answering session actions and sending or receiving fragmented
+ * blobs.
+ *
+ * Everything a role sends goes through the queue (see rn_txqueue.h) in
+ * one of the control, telemetry or bulk classes, and leaves at the next
+ * flush() once the peer has had RN_TXQ_GAP ms to turn around.
+ *
+ * The roles are Transmitter, Relay (the drone) and Receiver. Each project
+ * selects its role with one of the build flags NODE_ROLE_TRANSMITTER,
+ * NODE_ROLE_RELAY or NODE_ROLE_RECEIVER in platformio.ini, so the other
+ * roles are not compiled into its image.
+ */
+#ifndef RN_NODE_H
+#define RN_NODE_H
+
+#ifdef ARDUINO
+
+#include <Arduino.h>
+
+#include "rn_channel.h"
+#include "rn_frame.h"
+#include "rn_fragment.h"
+#include "rn_radio.h"
+#include "rn_session.h"
+#include "rn_supervisor.h"
+#include "rn_txqueue.h"
+
+#define STATUS_LED_RECEIVING 2
+#define STATUS_LED_SENDING   3
+#define STATUS_LED_CONNECTED 4
+
+#define START_MESSAGE "START"
+#define END_MESSAGE   "END"
+
+// Baud rate of the serial monitor
+#ifndef NODE_SERIAL_BAUD
+#define NODE_SERIAL_BAUD 9600
+#endif
+
+// Symbols listened for after a fragment, 0.5 s at SF12/250 kHz, so the
+// peer's control frames are heard between the fragments of a blob
+#ifndef NODE_BLOB_SLOT
+#define NODE_BLOB_SLOT 32
+#endif
+
+class Node {
+protected:
+  Node() : supervisor(NULL), triedConnIndex(1), blob_id(0), blob_data(NULL), blob_len(0) { blob.total = 0; }
+
+  // A role's handler for a frame from the peer of a session, expected
+  // saying whether one was due. Roles pass their own member function.
+  typedef rn_msg_type (Node::*message_hook)(const String &msg, bool expected);
+
+  // Opens the serial ports, starts the supervisor and brings the radio up on channel
+  void start(uint8_t channel, uint16_t watchdog_ms, unsigned long serial_baud = NODE_SERIAL_BAUD);
+
+  void status_led_connected(bool ledStatus);
+  void status_led_sending(bool ledStatus);
+  void status_led_receiving(bool ledStatus);
+
+  rn_msg_type message_type(const String &msg);
+
+  // Queues a frame in a class, it is sent by the next flush()
+  bool queue(rn_tx_class cls, const uint8_t *data, size_t len);
+  bool queue(rn_tx_class cls, const String &msg);
+
+  // Sends what is queued, highest class first, until the queue is empty or
+  // the duty cycle budget holds back the rest
+  void flush();
+
+  // Queues a message and flushes
+  void send(rn_tx_class cls, const String &msg);
+
+  // Sends START, packet and END as one telemetry burst. Returns false
+  // without sending anything if the budget cannot take all three.
+  bool send_burst(const String &packet);
+
+  // Airtime in ms of the burst send_burst() would send
+  uint32_t burst_airtime(const String &packet);
+
+  // Sends the message a session action asks for, if any
+  void send_session_action(const rn_session *session, rn_session_action action);
+
+  // Listens where the session says: its channel once established, else the rendezvous
+  void tune(const rn_session *session, uint8_t rendezvous);
+
+  uint16_t new_session_id();
+
+  /*
+   * Opens or resumes a session as the initiator, up to five tries from the
+   * rendezvous channel. The node owning the channel plan passes the channel
+   * to announce, the other RN_CHANNEL_NONE. Returns true once established.
+   */
+  bool connection_request(rn_session *session, uint8_t rendezvous, uint8_t channel);
+
+  /*
+   * Collects a burst once its START was heard. Every frame goes to message
+   * as expected, the packet ends up in packet with its SNR and this node's
+   * telemetry under tag appended. False if a frame went missing or a new
+   * handshake broke the burst off.
+   */
+  bool receive_burst(message_hook message, const char *tag, String *packet);
+
+  // ",<tag>:..." with this node's fault counters, appended to every packet.
+  // FT, FD and FR are the transmitter's, the drone's and the receiver's.
+  String telemetry(const char *tag);
+
+  /*
+   * Starts sending a message of up to RN_FRAG_MAX_MESSAGE bytes as
+   * fragments, see rn_fragment.h for the rounds. data must stay unchanged
+   * until blob_busy() is false. Returns false if a blob is still being
+   * sent or the message does not fit.
+   */
+  bool start_blob(const uint8_t *data, size_t len);
+  bool blob_busy() const { return rn_blob_busy(&blob); }
+
+  /*
+   * Sends the blob's next fragment and listens for NODE_BLOB_SLOT symbols,
+   * or after the fragment asking for the ack, for the ack. The role calls
+   * it once per loop pass, so control frames queued meanwhile go out
+   * before the next fragment. While the duty cycle budget cannot take a
+   * fragment the blob waits, nothing is sent or listened for. Whatever was
+   * heard that is not the ack goes to heard, for the role to handle like
+   * any other message. Returns RN_BLOB_DONE or RN_BLOB_FAILED once, when
+   * the blob is over.
+   */
+  rn_blob_result blob_step(String *heard);
+
+  // Stores the fragment in radio.frame() and acks if the sender asks for it
+  rn_frag_result receive_fragment(rn_reassembly *reassembly);
+
+  rn_supervisor *supervisor;
+  Radio radio;
+  rn_txqueue txq;
+  int triedConnIndex; // rounds of connection_request() that failed, plus one
+  uint8_t blob_id;
+  rn_blob_sender blob;
+  const uint8_t *blob_data;
+  size_t blob_len;
+};
+
+#endif
+#endif
@@ -0,0 +1,286 @@
+#ifdef ARDUINO
+
+#include "rn_radio.h"
+#include "rn_channel.h"
+#include "rn_txqueue.h"
+
+Radio::Radio()
+  : _serial(RN_RADIO_RX_PIN, RN_RADIO_TX_PIN),
+    _radio(_serial),
+    _supervisor(NULL),
+    _watchdog_ms(0),
+    _channel(RN_CHANNEL_NONE),
+    _frame_len(0),
+    _idle_since(0)
+{
+}
+
+void Radio::begin(uint8_t channel, uint16_t watchdog_ms, rn_supervisor *supervisor)
+{
+  _supervisor = supervisor;
+  _watchdog_ms = watchdog_ms;
+  _channel = channel;
+  _serial.begin(57600); //serial port to radio
+
+  //check communication with radio
+  _supervisor->phase = RN_PHASE_RADIO_SETUP;
+  while(!reset())
+  {
+    Serial.println(F("Communication with RN2xx3 unsuccessful. Resetting it again."));
+    // The MCU is reset once if the module stays silent, after that only the module is
+    if (rn_supervisor_fault(_supervisor, RN_FAULT_NO_ANSWER) == RN_RECOVER_RESET_MCU){
+      rn_supervisor_reboot(_supervisor);
+    }
+    rn_supervisor_delay(RN_RADIO_RETRY_DELAY);
+  }
+  healthy();
+  Serial.println(_radio.sysver());
+  configure();
+  _supervisor->phase = RN_PHASE_LOOP;
+}
+
+bool Radio::reset()
+{
+  //reset rn2483
+  pinMode(RN_RADIO_RESET_PIN, OUTPUT);
+  digitalWrite(RN_RADIO_RESET_PIN, LOW);
+  delay(500);
+  digitalWrite(RN_RADIO_RESET_PIN, HIGH);
+
+  delay(100); //wait for the RN2xx3's startup message
+  _serial.flush();
+
+  //Autobaud the rn2483 module to 9600. The default would otherwise be 57600.
+  //Same handshake as rn2xx3::autobaud(), which may block longer than the watchdog allows.
+  String response = "";
+  for (int attempt = 0; attempt < RN_RADIO_AUTOBAUD_TRIES && response.length() == 0; ++attempt){
+    rn_supervisor_delay(1000);
+    _serial.write((uint8_t)0x00);
+    _serial.write((uint8_t)0x55);
+    _serial.println();
+    _serial.println("sys get ver");
+    response = _serial.readStringUntil('\n');
+  }
+  return answering();
+}
+
+bool Radio::answering()
+{
+  rn_supervisor_feed();
+  String hweui = _radio.hweui();
+  if (hweui.length() != 16){
+    Serial.println(hweui);
+    return false;
+  }
+  return true;
+}
+
+void Radio::configure()
+{
+  // LoRa setup commands, kept in flash until they are sent
+  String commands[] = {
+    F("sys reset"),                //Resets the board
+    F("radio set mod lora"),       //FSK, GFSK, LoRa
+    String(F("radio set freq ")) + String(rn_channel_frequency(_channel)), //frequency
+    F("radio set pwr 14"),         //Power mode 13.5dBm = 22,4mW
+    F("radio set sf sf12"),        //Automatic spreading factor
+    F("radio set afcbw 125"),      //Automatic frequency correction
+    F("radio set rxbw 250"),       //Receiving signal bandwidth
+    F("radio set fdev 5000"),      //Frequency deviation
+    F("radio set prlen 8"),        //Preamble length
+    F("radio set crc on"),         //Cyclic redundancy check
+    F("radio set cr 4/8"),         //Coding rate
+    String(F("radio set wdt ")) + String(_watchdog_ms), //Watch-dog timeout time in ms
+    F("radio set sync 12"),        //Sync word with a value 0x12
+    F("radio set bw 250"),         //Operating bandwidth
+    F("sys get hweui"),            //Shows the hardware EUI needed for LoRaWAN operations
+    F("mac pause")                 //Pauses the LoRaWAN functionality
+  };
+
+  Serial.println(F("Initializing LoRa module"));
+  for (size_t index = 0; index < sizeof(commands) / sizeof(commands[0]); ++index){
+    rn_supervisor_feed();
+    Serial.println(String(F("Commad: ")) + commands[index] +F(": ") + _radio.sendRawCommand(commands[index]));
+  }
+  Serial.println(F("Radio Module initialized! "));
+}
+
+bool Radio::read_line(unsigned long timeout_ms, size_t *len)
+{
+  unsigned long start = millis();
+  while(_serial.available() == 0){
+    if (millis() - start > timeout_ms){
+      *len = 0;
+      _line[0] = '\0';
+      return false;
+    }
+    rn_supervisor_feed();
+  }
+  *len = read_reply();
+  return true;
+}
+
+size_t Radio::read_reply()
+{
+  size_t len = _serial.readBytesUntil('\n', _line, sizeof(_line) - 1);
+  if (len == sizeof(_line) - 1){
+    // No legal line is this long here, a cut off payload must not pass as a short one
+    _serial.find((char *)"\n");
+    Serial.println(F("Line too long, dropped"));
+    len = 0;
+  }
+  _line[len] = '\0';
+  return len;
+}
+
+void Radio::healthy()
+{
+  if (rn_supervisor_ok(_supervisor)){
+    rn_supervisor_save(_supervisor);
+  }
+}
+
+void Radio::recover(rn_fault fault)
+{
+  rn_recovery action = rn_supervisor_fault(_supervisor, fault);
+  Serial.println(String(F("Radio fault ")) + String((int)fault) + F(", recovery tier ") + String((int)action));
+
+  switch (action){
+  case RN_RECOVER_REARM:
+    _radio.sendRawCommand("radio rxstop");
+    while (_serial.available() > 0){
+      _serial.read();
+    }
+    break;
+  case RN_RECOVER_RECONFIGURE:
+    configure();
+    break;
+  case RN_RECOVER_RESET_RADIO:
+    if (reset()){
+      configure();
+    }
+    break;
+  case RN_RECOVER_RESET_MCU:
+    rn_supervisor_reboot(_supervisor);
+    break;
+  default:
+    break;
+  }
+}
+
+void Radio::send(const String &data)
+{
+  size_t len = data.length() < RN_RADIO_PAYLOAD_MAX ? data.length() : RN_RADIO_PAYLOAD_MAX;
+  send_frame((const uint8_t *)data.c_str(), len);
+}
+
+void Radio::send_frame(const uint8_t *data, size_t len)
+{
+  if (len > RN_RADIO_PAYLOAD_MAX){
+    return;
+  }
+  rn_msg_type type = rn_classify(data, len);
+  if (type == RN_MSG_FRAGMENT || type == RN_MSG_FRAG_ACK){
+    Serial.println(String(F("Sending frame: ")) + String((int)len) + F(" bytes"));
+  }
+  else {
+    Serial.print(F("Sending message: "));
+    Serial.write(data, len);
+    Serial.println();
+  }
+  // data may be frame() or a queued frame, copy it before the line is built
+  memmove(_line + RN_RADIO_TX_PREFIX, data, len);
+  transmit(len);
+}
+
+void Radio::transmit(size_t len)
+{
+  _supervisor->phase = RN_PHASE_SEND;
+  memcpy(_line, "radio tx ", RN_RADIO_TX_PREFIX);
+  rn_hex_encode((const uint8_t *)_line + RN_RADIO_TX_PREFIX, len, _line + RN_RADIO_TX_PREFIX);
+
+  // What rn2xx3::sendRawCommand() does, without the String copies
+  delay(100);
+  while (_serial.available() > 0){
+    _serial.read();
+  }
+  _serial.println(_line);
+  size_t reply = read_reply();
+  Serial.println(_line);
+  // After "ok" the frame is on the air until the module says radio_tx_ok or radio_err
+  size_t payload_len = 0;
+  if (rn_parse_line(_line, reply, NULL, 0, &payload_len) == RN_LINE_OK){
+    if (read_line(rn_airtime(len) + RN_RADIO_REPLY_TIMEOUT, &reply)){
+      healthy();
+      Serial.println(_line);
+    }
+    else {
+      Serial.println(F("No reply from the radio"));
+      recover(RN_FAULT_RX_TIMEOUT);
+    }
+  }
+  _frame_len = 0;
+  _idle_since = millis();
+  _supervisor->phase = RN_PHASE_LOOP;
+}
+
+String Radio::receive()
+{
+  size_t len = 0;
+  _supervisor->phase = RN_PHASE_RECEIVE;
+  Serial.println(String(F("radio rx 0: ")) + _radio.sendRawCommand("radio rx 0"));
+  // The module answers radio_err itself once its own watchdog runs out
+  if (read_line(_watchdog_ms + RN_RADIO_REPLY_TIMEOUT, &len)){
+    healthy();
+  }
+  else {
+    Serial.println(F("No reply from the radio"));
+    recover(RN_FAULT_RX_TIMEOUT);
+  }
+  // Only a radio_rx line is decoded in place, anything else is still intact for the log
+  rn_line_type type = rn_parse_line(_line, len, (uint8_t *)_line, RN_RADIO_PAYLOAD_MAX, &_frame_len);
+  if (type == RN_LINE_MALFORMED){
+    Serial.println(F("Malformed packet"));
+  }
+  else if (type != RN_LINE_RADIO_RX){
+    Serial.println(String(F("No packet: ")) + String(_line));
+  }
+  _line[_frame_len] = '\0';
+  _idle_since = millis();
+  _supervisor->phase = RN_PHASE_LOOP;
+  return String(_line);
+}
+
+bool Radio::listen(uint16_t symbols, int8_t *snr)
+{
+  size_t len = 0;
+  _supervisor->phase = RN_PHASE_LISTEN;
+  _radio.sendRawCommand("radio rx " + String(symbols));
+  // A symbol lasts 16.4 ms at SF12/250 kHz
+  if (read_line(symbols * 17UL + RN_RADIO_REPLY_TIMEOUT, &len)){
+    healthy();
+  }
+  else {
+    recover(RN_FAULT_RX_TIMEOUT);
+  }
+  rn_line_type type = rn_parse_line(_line, len, (uint8_t *)_line, RN_RADIO_PAYLOAD_MAX, &_frame_len);
+  _line[_frame_len] = '\0';
+  _idle_since = millis();
+  _supervisor->phase = RN_PHASE_LOOP;
+
+  bool busy = type == RN_LINE_RADIO_RX || type == RN_LINE_MALFORMED;
+  *snr = busy ? (int8_t)_radio.getSNR() : 0;
+  return busy;
+}
+
+void Radio::tune(uint8_t channel)
+{
+  if (channel == _channel){
+    return;
+  }
+  String frequency = String(rn_channel_frequency(channel));
+  Serial.println(String(F("Changing frequency: ")) + frequency  + _radio.sendRawCommand("radio set freq " + frequency));
+  _channel = channel;
+}
+
+#endif
@@ -0,0 +1,119 @@
+/*
+ * Driver for the RN2483 on the SoftwareSerial port of the node.
+ *
+ * Wraps the rn2xx3 library with the project's module setup, message and
+ * frame sending, and a receive that keeps the raw payload so binary
+ * frames (fragments, acks) survive next to the text messages.
+ *
+ * Payloads do not go through rn2xx3's base16encode()/base16decode() and
+ * their String copies. "radio tx" is built and "radio_rx" lines are read
+ * in one fixed line buffer, and the hex is encoded and decoded in place
+ * with the table driven codec in rn_frame.
+ *
+ * Every wait for the module has an MCU side deadline and feeds the
+ * watchdog. A missed deadline or a module that does not answer is handed
+ * to the supervisor, and the radio runs the recovery it picks.
+ */
+#ifndef RN_RADIO_H
+#define RN_RADIO_H
+
+#ifdef ARDUINO
+
+#include <Arduino.h>
+#include <SoftwareSerial.h>
+#include <rn2xx3.h>
+
+#include "rn_frame.h"
+#include "rn_supervisor.h"
+
+#define RN_RADIO_RX_PIN    10
+#define RN_RADIO_TX_PIN    11
+#define RN_RADIO_RESET_PIN 12
+
+// Grace in ms on top of the module's own timeout before the MCU gives up on a reply
+#ifndef RN_RADIO_REPLY_TIMEOUT
+#define RN_RADIO_REPLY_TIMEOUT 5000UL
+#endif
+// Pause in ms between attempts to reach a module that does not answer
+#ifndef RN_RADIO_RETRY_DELAY
+#define RN_RADIO_RETRY_DELAY 10000UL
+#endif
+#define RN_RADIO_AUTOBAUD_TRIES 10
+
+// Largest payload the node sends or receives. The UNO transmitter only
+// handles short frames and sets a smaller one to save RAM, a longer line
+// from the module is dropped whole.
+#ifndef RN_RADIO_PAYLOAD_MAX
+#define RN_RADIO_PAYLOAD_MAX RN_MAX_PAYLOAD
+#endif
+
+#define RN_RADIO_TX_PREFIX 9 // strlen("radio tx ")
+// "radio tx " or "radio_rx  " with the hex of the largest payload, "\r\n" and a NUL
+#define RN_RADIO_LINE_MAX  (2 * RN_RADIO_PAYLOAD_MAX + 16)
+
+class Radio {
+public:
+  Radio();
+
+  // Resets the module, waits until it answers and configures it on channel
+  void begin(uint8_t channel, uint16_t watchdog_ms, rn_supervisor *supervisor);
+
+  // Sends a text message
+  void send(const String &data);
+
+  // Sends a text or binary frame, at most RN_RADIO_PAYLOAD_MAX bytes
+  void send_frame(const uint8_t *data, size_t len);
+
+  // Waits for one frame, returns it as text. The raw bytes stay in frame()
+  // until the next send or receive. Returns an empty string if the module
+  // did not reply in time.
+  String receive();
+
+  // Listens for a window of symbols, true if something was on the air
+  bool listen(uint16_t symbols, int8_t *snr);
+
+  // Changes frequency only if the channel differs from the current one
+  void tune(uint8_t channel);
+
+  uint8_t channel() const { return _channel; }
+  // millis() when the last frame left the air or the last receive ended
+  unsigned long idle_since() const { return _idle_since; }
+  const uint8_t *frame() const { return (const uint8_t *)_line; }
+  size_t frame_len() const { return _frame_len; }
+  int snr() { return _radio.getSNR(); }
+
+private:
+  // Pulses the reset pin and autobauds, true once the module answers
+  bool reset();
+  bool answering();
+  void configure();
+
+  // The module replied, ends a fault streak
+  void healthy();
+
+  // Waits for one line from the module until timeout_ms passes, feeding the watchdog
+  bool read_line(unsigned long timeout_ms, size_t *len);
+
+  // Reads one line into _line within the stream timeout, returns its length,
+  // 0 for a line too long for _line
+  size_t read_reply();
+
+  // Hex encodes the len payload bytes at _line + RN_RADIO_TX_PREFIX in place, sends them and
+  // waits until the frame is off the air
+  void transmit(size_t len);
+
+  // Reports a fault to the supervisor and runs the recovery it picks
+  void recover(rn_fault fault);
+
+  SoftwareSerial _serial;
+  rn2xx3 _radio;
+  rn_supervisor *_supervisor;
+  uint16_t _watchdog_ms; // the module's own rx timeout
+  uint8_t _channel;
+  char _line[RN_RADIO_LINE_MAX]; // last line, a received payload is decoded in place
+  size_t _frame_len;
+  unsigned long _idle_since;
+};
+
+#endif
+#endif
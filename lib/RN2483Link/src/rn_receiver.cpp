@@ -0,0 +1,83 @@
+#if defined(ARDUINO) && defined(NODE_ROLE_RECEIVER)
+
+#include "rn_receiver.h"
+#include "rn_channel.h"
+
+#define RECEIVER_RADIO_WDT 10000
+
+void Receiver::setup()
+{
+#ifdef RECEIVER_UPLINK
+  start(RN_CHANNEL_DOWNLINK_RENDEZVOUS, RECEIVER_RADIO_WDT, RN_UPLINK_BAUD);
+#else
+  start(RN_CHANNEL_DOWNLINK_RENDEZVOUS, RECEIVER_RADIO_WDT);
+#endif
+  rn_session_init(&session);
+  rn_reassembly_init(&reassembly);
+  delay(100);
+}
+
+void Receiver::uplink()
+{
+#ifdef RECEIVER_UPLINK
+  if (radio.frame_len() > 0){
+    rn_uplink_record record;
+    uint8_t frame[RN_UPLINK_FRAME_MAX];
+    record.millis = millis();
+    record.snr = (int8_t)radio.snr();
+    record.channel = radio.channel();
+    record.length = (uint8_t)radio.frame_len();
+    memcpy(record.payload, radio.frame(), record.length);
+    Serial.write(frame, rn_uplink_encode(&record, frame));
+  }
+#endif
+}
+
+rn_msg_type Receiver::session_message(const String &msg, bool expected)
+{
+  uplink();
+  if (msg.length() == 0 && !expected){
+    return RN_MSG_NONE;
+  }
+  rn_session_action action = rn_session_message(&session, (const uint8_t *)msg.c_str(), msg.length(), millis());
+  if (action != RN_ACT_NONE){
+    Serial.println(String(F("Session ")) + String(session.id) + F(" request."));
+    send_session_action(&session, action);
+  }
+  return message_type(msg);
+}
+
+void Receiver::loop()
+{
+  rn_session_poll(&session, millis());
+  bool was_connected = rn_session_established(&session);
+  tune(&session, RN_CHANNEL_DOWNLINK_RENDEZVOUS);
+
+  forward_packets = false;
+  conn = radio.receive();
+  Serial.println(conn);
+
+  // The drone is quiet between bursts, for as long as its budget says
+  rn_msg_type type = session_message(conn, false);
+  if (type == RN_MSG_FRAGMENT && rn_session_established(&session)){
+    receive_fragment(&reassembly);
+  }
+  if (type == RN_MSG_START && rn_session_established(&session)){
+    status_led_receiving(true);
+    forward_packets = receive_burst(static_cast<message_hook>(&Receiver::session_message), "FR", &packet);
+    status_led_receiving(false);
+    status_led_sending(forward_packets);
+
+    if(forward_packets){
+      send(RN_TX_CONTROL, packet);
+      forward_packets = false;
+      status_led_sending(forward_packets);
+    }
+  }
+
+  if (rn_session_established(&session) != was_connected){
+    status_led_connected(rn_session_established(&session));
+  }
+}
+
+#endif
@@ -0,0 +1,39 @@
+/*
+ * Receiver role: answers the drone's session, collects each burst and
+ * sends the packet back as confirmation, with its own SNR appended.
+ *
+ * Built with RECEIVER_UPLINK it also hands every payload it hears to the
+ * host as a binary record on the serial port, at RN_UPLINK_BAUD instead
+ * of the monitor's 9600 (see rn_uplink.h and tools/rn_gateway).
+ */
+#ifndef RN_RECEIVER_H
+#define RN_RECEIVER_H
+
+#ifdef ARDUINO
+
+#include "rn_node.h"
+#include "rn_uplink.h"
+
+class Receiver : public Node {
+public:
+  void setup();
+  void loop();
+
+private:
+  // Feeds the message just received to the session and answers it if needed.
+  // Nothing heard only counts as a miss where a frame was expected.
+  rn_msg_type session_message(const String &msg, bool expected);
+
+  // With RECEIVER_UPLINK, forwards the frame just received to the host
+  void uplink();
+
+  rn_session session;
+  rn_reassembly reassembly;
+
+  bool forward_packets;
+  String conn;
+  String packet;
+};
+
+#endif
+#endif
@@ -0,0 +1,212 @@
+#if defined(ARDUINO) && defined(NODE_ROLE_RELAY)
+
+#include "rn_relay.h"
+
+#define RELAY_RADIO_WDT 10000
+
+Relay::Relay()
+  : forward_packets(false)
+{
+}
+
+void Relay::setup()
+{
+  start(RN_CHANNEL_UPLINK_RENDEZVOUS, RELAY_RADIO_WDT);
+  rn_session_init(&upstream);
+  rn_session_init(&downstream);
+  rn_channel_plan_init(&plan);
+  rn_reassembly_init(&reassembly);
+  scan_channels();
+  delay(100);
+}
+
+void Relay::scan_channels()
+{
+  int8_t snr = 0;
+
+  Serial.println(F("Scanning channels"));
+  for (uint8_t channel = 0; channel < RN_CHANNEL_COUNT; ++channel){
+    radio.tune(channel);
+    for (int sample = 0; sample < RN_CHANNEL_SCAN_SAMPLES; ++sample){
+      bool busy = radio.listen(RN_CHANNEL_SCAN_WINDOW, &snr);
+      rn_channel_sample(&plan, channel, busy, snr);
+    }
+    Serial.println(String(F("Channel ")) + String(channel) + F(" score: ") + String(rn_channel_score(&plan, channel)));
+  }
+  radio.tune(RN_CHANNEL_UPLINK_RENDEZVOUS);
+}
+
+bool Relay::connection_request()
+{
+  // The receiver's hop goes on the cleanest channel the transmitter's is not on
+  return Node::connection_request(&downstream, RN_CHANNEL_DOWNLINK_RENDEZVOUS,
+                                  rn_channel_pick(&plan, RN_CHANNEL_BIT(upstream.channel)));
+}
+
+rn_msg_type Relay::upstream_message(const String &msg, bool expected)
+{
+  rn_msg_type type = message_type(msg);
+  uint8_t heard_on = radio.channel();
+
+  if (type == RN_MSG_NONE && !expected){
+    // Waiting out its budget or a DEFER, the transmitter is quiet for minutes
+    return type;
+  }
+
+  if (rn_session_established(&upstream)){
+    rn_channel_record(&plan, heard_on, type != RN_MSG_NONE);
+  }
+
+  if (type == RN_MSG_CONNECT){
+    Serial.println(F("Connection requested. Trying to connect receiver"));
+    if (!rn_session_established(&downstream) && !connection_request()){
+      Serial.println(F("Connection failed. Informing sender."));
+      radio.tune(heard_on);
+      send(RN_TX_CONTROL, F("Couldn't connect receiver"));
+      return type;
+    }
+    radio.tune(heard_on);
+  }
+
+  rn_session_action action = rn_session_message(&upstream, (const uint8_t *)msg.c_str(), msg.length(), millis());
+  if (action == RN_ACT_SEND_REJECT){
+    Serial.println(String(F("Unknown session ")) + String(upstream.rejected) + F(". Rejecting resume."));
+    send_session_action(&upstream, action);
+  }
+  else if (action != RN_ACT_NONE){
+    // Announce the channel to use from now on, a resume may move to a backup
+    upstream.channel = rn_channel_pick(&plan, RN_CHANNEL_BIT(downstream.channel));
+    Serial.println(String(F("Session ")) + String(upstream.id) + F(" confirmed on channel ") + String(upstream.channel) + F(". Informing sender."));
+    send_session_action(&upstream, action);
+  }
+  return type;
+}
+
+void Relay::forward_burst()
+{
+  if (!rn_session_established(&downstream) && !connection_request()){
+    tune(&upstream, RN_CHANNEL_UPLINK_RENDEZVOUS);
+    send(RN_TX_CONTROL, F("Couldn't connect receiver"));
+    return;
+  }
+
+  tune(&downstream, RN_CHANNEL_DOWNLINK_RENDEZVOUS);
+  if (!send_burst(packet)){
+    // Not a loss, tell the transmitter when the budget can take the burst
+    uint32_t wait = rn_txq_wait(&txq, RN_TX_TELEMETRY, burst_airtime(packet), millis());
+    tune(&upstream, RN_CHANNEL_UPLINK_RENDEZVOUS);
+    send(RN_TX_CONTROL, "DEFER/" + String((wait + 999) / 1000));
+    return;
+  }
+
+  resp = radio.receive();
+  rn_session_message(&downstream, (const uint8_t *)resp.c_str(), resp.length(), millis());
+  rn_channel_record(&plan, radio.channel(), message_type(resp) == RN_MSG_PACKET);
+
+  hop_if_degraded(&downstream, &upstream);
+
+  tune(&upstream, RN_CHANNEL_UPLINK_RENDEZVOUS);
+  if (message_type(resp) == RN_MSG_PACKET){
+    // The transmitter takes a HOP while it waits for the confirmation, both still on the old channel
+    hop_if_degraded(&upstream, &downstream);
+    send(RN_TX_CONTROL, resp);
+  }
+  else {
+    send(RN_TX_CONTROL, F("Sending/receiving packets failed!"));
+  }
+}
+
+void Relay::hop_if_degraded(rn_session *session, const rn_session *other)
+{
+  if (!rn_session_established(session) || !rn_channel_degraded(&plan, session->channel)){
+    return;
+  }
+  uint8_t backup = rn_channel_pick(&plan, RN_CHANNEL_BIT(other->channel));
+  if (backup != session->channel){
+    Serial.println(String(F("Channel ")) + String(session->channel) + F(" degraded. Hopping to ") + String(backup));
+    send(RN_TX_CONTROL, "HOP/" + String(session->id) + "/" + String(backup));
+    session->channel = backup;
+  }
+}
+
+void Relay::relay_fragment()
+{
+  // The blob being relayed is sent out of reassembly, a new one waits until it is through
+  if (blob_busy() && !rn_reassembly_holds(&reassembly, radio.frame(), radio.frame_len())){
+    Serial.println(F("Still relaying a blob, fragment dropped"));
+    return;
+  }
+  if (receive_fragment(&reassembly) != RN_FRAG_COMPLETE){
+    return;
+  }
+
+  if (!rn_session_established(&downstream) && !connection_request()){
+    tune(&upstream, RN_CHANNEL_UPLINK_RENDEZVOUS);
+    return;
+  }
+  start_blob(reassembly.data, reassembly.length);
+}
+
+String Relay::relay_blob_step()
+{
+  String heard;
+  tune(&downstream, RN_CHANNEL_DOWNLINK_RENDEZVOUS);
+  rn_blob_result result = blob_step(&heard);
+  if (heard.length() > 0){
+    rn_session_message(&downstream, (const uint8_t *)heard.c_str(), heard.length(), millis());
+  }
+  if (result != RN_BLOB_SENDING){
+    rn_channel_record(&plan, radio.channel(), result == RN_BLOB_DONE);
+  }
+
+  // A short slot upstream instead of a whole receive, so the blob keeps moving
+  int8_t snr = 0;
+  tune(&upstream, RN_CHANNEL_UPLINK_RENDEZVOUS);
+  if (!radio.listen(NODE_BLOB_SLOT, &snr)){
+    return "";
+  }
+  return String((const char *)radio.frame());
+}
+
+void Relay::loop()
+{
+  rn_session_poll(&upstream, millis());
+  rn_session_poll(&downstream, millis());
+  bool was_connected = rn_session_established(&upstream);
+
+  forward_packets = false;
+  tune(&upstream, RN_CHANNEL_UPLINK_RENDEZVOUS);
+  if (blob_busy()){
+    resp = relay_blob_step();
+    if (resp.length() == 0){
+      // A quiet slot is no missed frame
+      return;
+    }
+  }
+  else {
+    resp = radio.receive();
+  }
+  Serial.println(resp);
+
+  rn_msg_type type = upstream_message(resp, false);
+  if (type == RN_MSG_FRAGMENT && rn_session_established(&upstream)){
+    relay_fragment();
+  }
+  if (type == RN_MSG_START && rn_session_established(&upstream)){
+    status_led_receiving(true);
+    forward_packets = receive_burst(static_cast<message_hook>(&Relay::upstream_message), "FD", &packet);
+    status_led_receiving(false);
+    status_led_sending(forward_packets);
+
+    if(forward_packets){
+      forward_burst();
+      forward_packets = false;
+      status_led_sending(forward_packets);
+    }
+  }
+  if (rn_session_established(&upstream) != was_connected){
+    status_led_connected(rn_session_established(&upstream));
+  }
+}
+
+#endif
@@ -0,0 +1,63 @@
+/*
+ * Relay role, run on the drone: answers the transmitter's session, opens
+ * its own session with the receiver, forwards bursts and blobs, and owns
+ * the channel plan of both hops.
+ */
+#ifndef RN_RELAY_H
+#define RN_RELAY_H
+
+#ifdef ARDUINO
+
+#include "rn_channel.h"
+#include "rn_node.h"
+
+class Relay : public Node {
+public:
+  Relay();
+
+  void setup();
+  void loop();
+
+private:
+  // Listens on every candidate channel for a few short windows to see how busy it is
+  void scan_channels();
+
+  // Opens or resumes the session with the receiver
+  bool connection_request();
+
+  /*
+   * Feeds a message from the transmitter to the upstream session. A new
+   * session is only confirmed once the receiver is reachable, but if the
+   * downstream session is still up the transmitter gets its answer without
+   * another handshake on the second hop. expected says whether a frame
+   * was due, between bursts the transmitter is quiet and that is neither
+   * loss nor a missed frame.
+   */
+  rn_msg_type upstream_message(const String &msg, bool expected);
+
+  // Sends the burst on to the receiver and its confirmation back to the transmitter
+  void forward_burst();
+
+  // Moves a hop to a backup channel before its loss suspends the session,
+  // other is the session of the hop it must not share a channel with
+  void hop_if_degraded(rn_session *session, const rn_session *other);
+
+  // Stores a fragment from the transmitter and starts relaying the blob once it is complete
+  void relay_fragment();
+
+  // Sends the next fragment of the blob to the receiver, then listens upstream
+  // for a short slot. Returns what the transmitter sent meanwhile, if anything.
+  String relay_blob_step();
+
+  rn_session upstream;   // with the transmitter, the drone answers
+  rn_session downstream; // with the receiver, the drone opens it
+  rn_channel_plan plan;
+  rn_reassembly reassembly;
+
+  bool forward_packets;
+  String resp;
+  String packet;
+};
+
+#endif
+#endif
@@ -0,0 +1,263 @@
+#include "rn_session.h"
+#include "rn_channel.h"
+#include "rn_frame.h"
+
+#include <stdio.h>
+
+#define ANY_STATE 0xFF
+
+struct transition {
+  uint8_t state;
+  uint8_t event;
+  uint8_t next;
+  uint8_t action;
+};
+
+// First matching row wins, so the ANY_STATE rows at the end are fallbacks
+static const transition transitions[] = {
+  // Initiator
+  {RN_SESSION_IDLE,        RN_EV_OPEN,     RN_SESSION_CONNECTING,  RN_ACT_SEND_CONNECT},
+  {RN_SESSION_CONNECTING,  RN_EV_OPEN,     RN_SESSION_CONNECTING,  RN_ACT_SEND_CONNECT},
+  {RN_SESSION_CONNECTING,  RN_EV_ACCEPTED, RN_SESSION_ESTABLISHED, RN_ACT_NONE},
+  {RN_SESSION_CONNECTING,  RN_EV_TIMEOUT,  RN_SESSION_IDLE,        RN_ACT_NONE},
+  {RN_SESSION_SUSPENDED,   RN_EV_OPEN,     RN_SESSION_RESUMING,    RN_ACT_SEND_RESUME},
+  {RN_SESSION_RESUMING,    RN_EV_OPEN,     RN_SESSION_RESUMING,    RN_ACT_SEND_RESUME},
+  {RN_SESSION_RESUMING,    RN_EV_RESUMED,  RN_SESSION_ESTABLISHED, RN_ACT_NONE},
+  {RN_SESSION_RESUMING,    RN_EV_REJECTED, RN_SESSION_IDLE,        RN_ACT_NONE},
+  {RN_SESSION_RESUMING,    RN_EV_TIMEOUT,  RN_SESSION_IDLE,        RN_ACT_NONE},
+  {RN_SESSION_SUSPENDED,   RN_EV_REJECTED, RN_SESSION_IDLE,        RN_ACT_NONE},
+
+  // Responder
+  {RN_SESSION_ESTABLISHED, RN_EV_RESUME,   RN_SESSION_ESTABLISHED, RN_ACT_SEND_RESUMED},
+  {RN_SESSION_SUSPENDED,   RN_EV_RESUME,   RN_SESSION_ESTABLISHED, RN_ACT_SEND_RESUMED},
+
+  // Both
+  {RN_SESSION_ESTABLISHED, RN_EV_FRAME,    RN_SESSION_ESTABLISHED, RN_ACT_NONE},
+  {RN_SESSION_ESTABLISHED, RN_EV_LOST,     RN_SESSION_SUSPENDED,   RN_ACT_NONE},
+  {RN_SESSION_ESTABLISHED, RN_EV_TIMEOUT,  RN_SESSION_SUSPENDED,   RN_ACT_NONE},
+  {RN_SESSION_SUSPENDED,   RN_EV_FRAME,    RN_SESSION_ESTABLISHED, RN_ACT_NONE},
+  {RN_SESSION_SUSPENDED,   RN_EV_TIMEOUT,  RN_SESSION_IDLE,        RN_ACT_NONE},
+  {ANY_STATE,              RN_EV_CONNECT,  RN_SESSION_ESTABLISHED, RN_ACT_SEND_CONNECTED},
+  {ANY_STATE,              RN_EV_CLOSE,    RN_SESSION_IDLE,        RN_ACT_NONE},
+};
+
+static const uint32_t state_timeouts[RN_SESSION_STATE_COUNT] = {
+  0,                          // RN_SESSION_IDLE
+  RN_SESSION_CONNECT_TIMEOUT, // RN_SESSION_CONNECTING
+  RN_SESSION_IDLE_TIMEOUT,    // RN_SESSION_ESTABLISHED
+  RN_SESSION_SUSPEND_TIMEOUT, // RN_SESSION_SUSPENDED
+  RN_SESSION_RESUME_TIMEOUT   // RN_SESSION_RESUMING
+};
+
+// Events that carry a session id and must match the current one
+static bool needs_matching_id(uint8_t event)
+{
+  return event == RN_EV_ACCEPTED || event == RN_EV_RESUMED || event == RN_EV_REJECTED;
+}
+
+static void start_session(rn_session *s, uint16_t id)
+{
+  s->id = id;
+  s->tx_seq = 0;
+  s->rx_seq = 0;
+  s->channel = RN_CHANNEL_NONE;
+}
+
+void rn_session_init(rn_session *s)
+{
+  s->state = RN_SESSION_IDLE;
+  s->misses = 0;
+  s->rejected = 0;
+  s->since = 0;
+  start_session(s, 0);
+}
+
+rn_session_action rn_session_event(rn_session *s, uint8_t event, uint16_t id, uint32_t now)
+{
+  if (needs_matching_id(event) && id != s->id) {
+    return RN_ACT_NONE;
+  }
+  // Only a responder holding the session can resume it, anyone else tells
+  // the initiator to connect anew instead of letting it wait for a timeout
+  if (event == RN_EV_RESUME && (id != s->id || (s->state != RN_SESSION_ESTABLISHED
+                                                && s->state != RN_SESSION_SUSPENDED))) {
+    s->rejected = id;
+    return RN_ACT_SEND_REJECT;
+  }
+
+  // A miss only suspends the session once enough of them pile up
+  if (event == RN_EV_MISS) {
+    if (s->state != RN_SESSION_ESTABLISHED || ++s->misses < RN_SESSION_MAX_MISSES) {
+      return RN_ACT_NONE;
+    }
+    event = RN_EV_LOST;
+  }
+
+  for (size_t i = 0; i < sizeof(transitions) / sizeof(transitions[0]); ++i) {
+    const transition &t = transitions[i];
+    if ((t.state != s->state && t.state != ANY_STATE) || t.event != event) {
+      continue;
+    }
+
+    if (event == RN_EV_OPEN && s->state == RN_SESSION_IDLE) {
+      start_session(s, id);
+    }
+    // A repeated CONNECT for the current session means our CONNECTED got
+    // lost, answer again but keep the sequence numbers
+    if (event == RN_EV_CONNECT && (id != s->id || s->state == RN_SESSION_IDLE)) {
+      start_session(s, id);
+    }
+    if (t.next == RN_SESSION_IDLE) {
+      start_session(s, 0);
+    }
+
+    // Resending CONNECT or RESUME must not push the attempt's timeout out
+    if (t.next != s->state || event != RN_EV_OPEN) {
+      s->since = now;
+    }
+    s->state = t.next;
+    s->misses = 0;
+    return (rn_session_action)t.action;
+  }
+  return RN_ACT_NONE;
+}
+
+rn_session_action rn_session_poll(rn_session *s, uint32_t now)
+{
+  uint32_t timeout = state_timeouts[s->state];
+  if (timeout == 0 || now - s->since < timeout) {
+    return RN_ACT_NONE;
+  }
+  return rn_session_event(s, RN_EV_TIMEOUT, 0, now);
+}
+
+// Adopts the channel announced in field index if the message was for this session
+static void adopt_channel(rn_session *s, const uint8_t *msg, size_t len, uint8_t index, uint32_t id)
+{
+  uint32_t channel = 0;
+  if (id == s->id && rn_session_established(s)
+      && rn_field_uint(msg, len, index, &channel) && channel < RN_CHANNEL_COUNT) {
+    s->channel = (uint8_t)channel;
+  }
+}
+
+// Session id in field 1, session 0 means idle so only 1..65535 is usable
+static bool session_id(const uint8_t *msg, size_t len, uint32_t *id)
+{
+  return rn_field_uint(msg, len, 1, id) && *id != 0 && *id <= 0xFFFF;
+}
+
+rn_session_action rn_session_message(rn_session *s, const uint8_t *msg, size_t len, uint32_t now)
+{
+  uint32_t id = 0;
+  uint32_t seq = 0;
+  rn_session_action action;
+
+  switch (rn_classify(msg, len)) {
+  case RN_MSG_NONE:
+    return rn_session_event(s, RN_EV_MISS, 0, now);
+  case RN_MSG_CONNECT:
+    if (!session_id(msg, len, &id)) {
+      return RN_ACT_NONE;
+    }
+    action = rn_session_event(s, RN_EV_CONNECT, (uint16_t)id, now);
+    adopt_channel(s, msg, len, 2, id);
+    return action;
+  case RN_MSG_CONNECTED:
+    if (!session_id(msg, len, &id)) {
+      return RN_ACT_NONE;
+    }
+    action = rn_session_event(s, RN_EV_ACCEPTED, (uint16_t)id, now);
+    adopt_channel(s, msg, len, 2, id);
+    return action;
+  case RN_MSG_RESUME:
+    if (!session_id(msg, len, &id)) {
+      return RN_ACT_NONE;
+    }
+    action = rn_session_event(s, RN_EV_RESUME, (uint16_t)id, now);
+    adopt_channel(s, msg, len, 3, id);
+    return action;
+  case RN_MSG_RESUMED:
+    if (!session_id(msg, len, &id)) {
+      return RN_ACT_NONE;
+    }
+    action = rn_session_event(s, RN_EV_RESUMED, (uint16_t)id, now);
+    adopt_channel(s, msg, len, 3, id);
+    return action;
+  case RN_MSG_REJECT:
+    if (!session_id(msg, len, &id)) {
+      return RN_ACT_NONE;
+    }
+    return rn_session_event(s, RN_EV_REJECTED, (uint16_t)id, now);
+  case RN_MSG_HOP:
+    if (!session_id(msg, len, &id) || id != s->id) {
+      return RN_ACT_NONE;
+    }
+    action = rn_session_event(s, RN_EV_FRAME, 0, now);
+    adopt_channel(s, msg, len, 2, id);
+    return action;
+  case RN_MSG_PACKET:
+    if (rn_field_uint(msg, len, 1, &seq) && rn_session_established(s)) {
+      s->rx_seq = (uint16_t)seq;
+    }
+    return rn_session_event(s, RN_EV_FRAME, 0, now);
+  case RN_MSG_DEFER:
+  case RN_MSG_START:
+  case RN_MSG_END:
+  case RN_MSG_FRAGMENT:
+  case RN_MSG_FRAG_ACK:
+    return rn_session_event(s, RN_EV_FRAME, 0, now);
+  default:
+    return RN_ACT_NONE;
+  }
+}
+
+size_t rn_session_format(const rn_session *s, uint8_t action, char *buf, size_t capacity)
+{
+  int written;
+  int extra = 0;
+  switch (action) {
+  case RN_ACT_SEND_CONNECT:
+    written = RN_SNPRINTF(buf, capacity, "CONNECT/%u", (unsigned)s->id);
+    break;
+  case RN_ACT_SEND_CONNECTED:
+    written = RN_SNPRINTF(buf, capacity, "CONNECTED/%u", (unsigned)s->id);
+    break;
+  case RN_ACT_SEND_RESUME:
+    written = RN_SNPRINTF(buf, capacity, "RESUME/%u/%u", (unsigned)s->id, (unsigned)s->tx_seq);
+    break;
+  case RN_ACT_SEND_RESUMED:
+    written = RN_SNPRINTF(buf, capacity, "RESUMED/%u/%u", (unsigned)s->id, (unsigned)s->rx_seq);
+    break;
+  case RN_ACT_SEND_REJECT:
+    // About a session this node does not hold, so no channel either
+    written = RN_SNPRINTF(buf, capacity, "REJECT/%u", (unsigned)s->rejected);
+    return written < 0 || (size_t)written >= capacity ? 0 : (size_t)written;
+  default:
+    return 0;
+  }
+  if (written < 0 || (size_t)written >= capacity) {
+    return 0;
+  }
+
+  if (s->channel != RN_CHANNEL_NONE) {
+    extra = RN_SNPRINTF(buf + written, capacity - written, "/%u", (unsigned)s->channel);
+    if (extra < 0 || (size_t)(written + extra) >= capacity) {
+      return 0;
+    }
+  }
+  return (size_t)(written + extra);
+}
+
+bool rn_session_established(const rn_session *s)
+{
+  return s->state == RN_SESSION_ESTABLISHED;
+}
+
+uint8_t rn_session_channel(const rn_session *s, uint8_t rendezvous)
+{
+  if (rn_session_established(s) && s->channel != RN_CHANNEL_NONE) {
+    return s->channel;
+  }
+  return rendezvous;
+}
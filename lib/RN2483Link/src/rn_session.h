@@ -0,0 +1,124 @@
+/*
+ * Session state machine used on both ends of every hop.
+ *
+ * A session is opened by the initiator (transmitter towards the drone,
+ * drone towards the receiver) with "CONNECT/<id>" and accepted by the
+ * responder with "CONNECTED/<id>". A node that misses a few frames does not
+ * drop the session, it suspends it and the initiator tries
+ * "RESUME/<id>/<seq>" first. Only if the peer no longer knows the session
+ * does the full CONNECT handshake run again, so one bad frame on the first
+ * hop no longer costs a handshake on the second hop as well. A peer that
+ * does not know the session answers "REJECT/<id>" and the initiator goes
+ * back to idle and connects anew right away. Resending CONNECT or RESUME
+ * does not restart the timeout of the attempt.
+ *
+ * The handshake messages may end with the channel the hop should use
+ * once established (see rn_channel.h). The node owning the channel plan
+ * sets session.channel before formatting its message, the peer adopts
+ * whatever it receives and echoes it back.
+ *
+ * All transitions live in one table in rn_session.cpp. The functions
+ * only return what should be sent, the sketch does the sending.
+ */
+#ifndef RN_SESSION_H
+#define RN_SESSION_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Frames in a row that may go missing before an established session is suspended
+#ifndef RN_SESSION_MAX_MISSES
+#define RN_SESSION_MAX_MISSES 3
+#endif
+
+// Timeouts in ms, 0 means the state never times out
+#ifndef RN_SESSION_CONNECT_TIMEOUT
+#define RN_SESSION_CONNECT_TIMEOUT 60000UL   // the drone connects the receiver meanwhile
+#endif
+// A hop may carry a burst only every ~13 min once the drone's 1% budget
+// runs out, relaying a burst and its confirmation costs it about 8 s of air
+#ifndef RN_SESSION_IDLE_TIMEOUT
+#define RN_SESSION_IDLE_TIMEOUT 900000UL     // no valid frame on an established session
+#endif
+#ifndef RN_SESSION_SUSPEND_TIMEOUT
+#define RN_SESSION_SUSPEND_TIMEOUT 900000UL  // how long a suspended session can be resumed
+#endif
+#ifndef RN_SESSION_RESUME_TIMEOUT
+#define RN_SESSION_RESUME_TIMEOUT 60000UL    // initiator gives up resuming and reconnects
+#endif
+
+enum rn_session_state {
+  RN_SESSION_IDLE,        // no session
+  RN_SESSION_CONNECTING,  // CONNECT sent, waiting for CONNECTED
+  RN_SESSION_ESTABLISHED, // frames flowing
+  RN_SESSION_SUSPENDED,   // lost sync, id and sequence numbers kept
+  RN_SESSION_RESUMING,    // RESUME sent, waiting for RESUMED
+  RN_SESSION_STATE_COUNT
+};
+
+enum rn_session_event {
+  RN_EV_OPEN,      // initiator wants a session, (re)sends CONNECT or RESUME
+  RN_EV_CONNECT,   // CONNECT received
+  RN_EV_ACCEPTED,  // CONNECTED received
+  RN_EV_RESUME,    // RESUME received
+  RN_EV_RESUMED,   // RESUMED received
+  RN_EV_REJECTED,  // REJECT received
+  RN_EV_FRAME,     // any other valid frame
+  RN_EV_MISS,      // nothing or garbage where a frame was expected
+  RN_EV_LOST,      // too many misses, raised internally
+  RN_EV_TIMEOUT,   // the current state timed out, raised by rn_session_poll()
+  RN_EV_CLOSE      // drop the session
+};
+
+enum rn_session_action {
+  RN_ACT_NONE,
+  RN_ACT_SEND_CONNECT,
+  RN_ACT_SEND_CONNECTED,
+  RN_ACT_SEND_RESUME,
+  RN_ACT_SEND_RESUMED,
+  RN_ACT_SEND_REJECT
+};
+
+struct rn_session {
+  uint8_t state;
+  uint8_t misses;   // frames missed in a row
+  uint16_t id;      // 0 while idle
+  uint16_t tx_seq;  // last sequence number sent
+  uint16_t rx_seq;  // last sequence number received
+  uint8_t channel;  // channel once established, RN_CHANNEL_NONE for the rendezvous channel
+  uint16_t rejected; // id of the last RESUME answered with REJECT
+  uint32_t since;   // millis() of the last state change or valid frame
+};
+
+void rn_session_init(rn_session *s);
+
+/*
+ * Feeds one event to the session. id is the session id carried by the
+ * message, or for RN_EV_OPEN the id to use if a new session is created;
+ * it is ignored for events without one. Events for another session id and
+ * events the current state does not handle are dropped.
+ */
+rn_session_action rn_session_event(rn_session *s, uint8_t event, uint16_t id, uint32_t now);
+
+// Raises RN_EV_TIMEOUT if the current state has been active for too long
+rn_session_action rn_session_poll(rn_session *s, uint32_t now);
+
+/*
+ * Classifies a received payload, extracts its session id, sequence number
+ * and channel and feeds the matching event. Text that is not part of the
+ * protocol is ignored, an empty payload counts as a miss.
+ */
+rn_session_action rn_session_message(rn_session *s, const uint8_t *msg, size_t len, uint32_t now);
+
+/*
+ * Writes the message for an action into buf, NUL terminated. Returns its
+ * length, 0 for RN_ACT_NONE or if buf is too small.
+ */
+size_t rn_session_format(const rn_session *s, uint8_t action, char *buf, size_t capacity);
+
+bool rn_session_established(const rn_session *s);
+
+// Channel the node should listen on: the session's while established, else the rendezvous
+uint8_t rn_session_channel(const rn_session *s, uint8_t rendezvous);
+
+#endif
@@ -0,0 +1,214 @@
+#include "rn_supervisor.h"
+#include "rn_frame.h"
+
+#include <stdio.h>
+#include <string.h>
+
+static uint8_t log_checksum(const rn_fault_log *log)
+{
+  const uint8_t *bytes = (const uint8_t *)log;
+  uint8_t sum = 0x5A;
+  for (size_t i = 0; i < offsetof(rn_fault_log, checksum); ++i) {
+    sum = (uint8_t)((sum << 1) | (sum >> 7)) ^ bytes[i];
+  }
+  return sum;
+}
+
+static void seal(rn_fault_log *log)
+{
+  log->checksum = log_checksum(log);
+}
+
+static void count(uint16_t *counter)
+{
+  if (*counter < 0xFFFF) {
+    ++*counter;
+  }
+}
+
+bool rn_fault_log_valid(const rn_fault_log *log)
+{
+  return log != NULL && log->magic == RN_SUPERVISOR_MAGIC && log->checksum == log_checksum(log);
+}
+
+void rn_supervisor_init(rn_supervisor *s, const rn_fault_log *stored)
+{
+  if (rn_fault_log_valid(stored)) {
+    s->log = *stored;
+  } else {
+    memset(&s->log, 0, sizeof(s->log));
+    s->log.magic = RN_SUPERVISOR_MAGIC;
+    s->log.last_fault = RN_FAULT_COUNT;
+  }
+  s->phase = RN_PHASE_BOOT;
+  s->streak = RN_RECOVER_NONE;
+  s->rebooted = false;
+  s->dirty = false;
+  seal(&s->log);
+}
+
+void rn_supervisor_boot(rn_supervisor *s, bool watchdog_reset)
+{
+  count(&s->log.boots);
+  // A reset the supervisor asked for is already counted as a recovery
+  if (watchdog_reset && s->phase != RN_PHASE_REBOOT) {
+    count(&s->log.faults[RN_FAULT_WATCHDOG]);
+    s->log.last_fault = RN_FAULT_WATCHDOG;
+    s->log.last_phase = s->phase;
+  }
+  s->phase = RN_PHASE_BOOT;
+  s->dirty = true;
+  seal(&s->log);
+}
+
+rn_recovery rn_supervisor_fault(rn_supervisor *s, rn_fault fault)
+{
+  // A module that does not answer at all gets reset right away
+  uint8_t entry = fault == RN_FAULT_NO_ANSWER ? RN_RECOVER_RESET_RADIO : RN_RECOVER_REARM;
+  if (s->streak < entry) {
+    s->streak = entry;
+  } else if (s->streak < RN_RECOVER_RESET_MCU) {
+    ++s->streak;
+  }
+
+  rn_recovery action = (rn_recovery)s->streak;
+  if (action == RN_RECOVER_RESET_MCU) {
+    if (s->rebooted) {
+      action = RN_RECOVER_RESET_RADIO;
+    }
+    s->rebooted = true;
+  }
+
+  if (fault < RN_FAULT_COUNT) {
+    count(&s->log.faults[fault]);
+  }
+  count(&s->log.recoveries[action]);
+  s->log.last_fault = fault;
+  s->log.last_phase = s->phase;
+  s->dirty = true;
+  seal(&s->log);
+  return action;
+}
+
+bool rn_supervisor_ok(rn_supervisor *s)
+{
+  bool save = s->dirty;
+  s->streak = RN_RECOVER_NONE;
+  s->rebooted = false;
+  s->dirty = false;
+  return save;
+}
+
+size_t rn_supervisor_format(const rn_supervisor *s, const char *tag, char *buf, size_t capacity)
+{
+  const rn_fault_log *log = &s->log;
+  int written = RN_SNPRINTF(buf, capacity, "%s:%u.%u.%u.%u.%u.%u.%u", tag,
+                         (unsigned)log->boots,
+                         (unsigned)log->faults[RN_FAULT_WATCHDOG],
+                         (unsigned)log->faults[RN_FAULT_RX_TIMEOUT],
+                         (unsigned)log->faults[RN_FAULT_NO_ANSWER],
+                         (unsigned)log->recoveries[RN_RECOVER_RESET_RADIO],
+                         (unsigned)log->recoveries[RN_RECOVER_RESET_MCU],
+                         (unsigned)log->last_phase);
+  if (written < 0 || (size_t)written >= capacity) {
+    return 0;
+  }
+  return (size_t)written;
+}
+
+#ifdef ARDUINO
+
+#include <Arduino.h>
+#include <EEPROM.h>
+#include <avr/wdt.h>
+
+// Not cleared by the C runtime, so both survive a watchdog reset
+static rn_supervisor state __attribute__((section(".noinit")));
+static uint8_t reset_flags __attribute__((section(".noinit")));
+
+/*
+ * Runs before the C runtime, called from .init3 below. The watchdog stays
+ * armed with its shortest period after it fired, so it is stopped here
+ * before it can fire again during startup.
+ */
+extern "C" void rn_supervisor_reset_flags(uint8_t handed_over) __attribute__((used));
+extern "C" void rn_supervisor_reset_flags(uint8_t handed_over)
+{
+  reset_flags = MCUSR | handed_over;
+  MCUSR = 0;
+  wdt_disable();
+}
+
+/*
+ * .init3 is code the startup falls through, so only basic asm is safe in
+ * it. The stack and r1 are set up by then. Optiboot clears MCUSR itself
+ * and hands the flags over in r2; other bootloaders leave r2 undefined.
+ * The host build of the roles (tools/test/arduino) has no .init3.
+ */
+#ifdef __AVR__
+static void rn_supervisor_early() __attribute__((naked, used, section(".init3")));
+static void rn_supervisor_early()
+{
+#ifdef RN_SUPERVISOR_OPTIBOOT
+  __asm__ __volatile__("mov r24, r2\n\tcall rn_supervisor_reset_flags");
+#else
+  __asm__ __volatile__("clr r24\n\tcall rn_supervisor_reset_flags");
+#endif
+}
+#endif
+
+rn_supervisor *rn_supervisor_begin()
+{
+  bool watchdog = (reset_flags & _BV(WDRF)) != 0;
+  bool power_on = (reset_flags & (_BV(PORF) | _BV(BORF))) != 0;
+
+  if (power_on || !rn_fault_log_valid(&state.log)) {
+    rn_fault_log stored;
+    EEPROM.get(RN_SUPERVISOR_EEPROM_ADDR, stored);
+    rn_supervisor_init(&state, &stored);
+  }
+  rn_supervisor_boot(&state, watchdog);
+  reset_flags = 0;
+
+  char counters[40];
+  if (rn_supervisor_format(&state, "Faults", counters, sizeof(counters)) > 0){
+    Serial.println(counters);
+  }
+  wdt_enable(RN_SUPERVISOR_WDT);
+  return &state;
+}
+
+void rn_supervisor_feed()
+{
+  wdt_reset();
+}
+
+void rn_supervisor_delay(unsigned long ms)
+{
+  while (ms > 1000){
+    wdt_reset();
+    delay(1000);
+    ms -= 1000;
+  }
+  wdt_reset();
+  delay(ms);
+}
+
+void rn_supervisor_save(rn_supervisor *s)
+{
+  EEPROM.put(RN_SUPERVISOR_EEPROM_ADDR, s->log);
+  s->dirty = false;
+}
+
+void rn_supervisor_reboot(rn_supervisor *s)
+{
+  Serial.println(F("Resetting the MCU"));
+  Serial.flush();
+  s->phase = RN_PHASE_REBOOT;
+  rn_supervisor_save(s);
+  wdt_enable(WDTO_15MS);
+  for (;;){
+  }
+}
+
+#endif
@@ -0,0 +1,138 @@
+/*
+ * Supervisor that keeps an unattended node alive.
+ *
+ * The AVR watchdog resets the MCU if the sketch stops feeding it, so a
+ * loop stuck inside a library call no longer needs a power cycle. Radio
+ * faults the sketch can see (no line from the module before the MCU side
+ * deadline, no answer to "sys get hweui") escalate one recovery tier per
+ * fault in a row:
+ *
+ *   1. re-arm the receiver ("radio rxstop", drop what is in the UART)
+ *   2. rerun the module setup commands
+ *   3. pulse the reset pin and set the module up again
+ *   4. reset the MCU through the watchdog
+ *
+ * Any line from the module ends the streak. The MCU is reset only once
+ * per streak, if that did not help the radio reset is retried instead.
+ *
+ * Fault and recovery counters, the boot count and the state the node was
+ * in at the last fault live in a checksummed record. A copy in .noinit RAM
+ * survives watchdog resets, and the record is written to EEPROM when the
+ * radio answers again after a fault or boot and right before an MCU
+ * reset, so a dead module does not wear out the EEPROM with a write per
+ * retry. The counters ride along with every packet as telemetry, see
+ * rn_supervisor_format().
+ *
+ * The counting and escalation below is plain C, the watchdog and EEPROM
+ * part is AVR only.
+ */
+#ifndef RN_SUPERVISOR_H
+#define RN_SUPERVISOR_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Define RN_SUPERVISOR_OPTIBOOT for boards booting through Optiboot (the
+// UNO), which hands the reset flags over in r2 instead of leaving MCUSR
+
+// EEPROM address of the fault record
+#ifndef RN_SUPERVISOR_EEPROM_ADDR
+#define RN_SUPERVISOR_EEPROM_ADDR 0
+#endif
+
+#define RN_SUPERVISOR_MAGIC 0x5244 // "RD", bump when rn_fault_log changes
+
+enum rn_fault {
+  RN_FAULT_WATCHDOG,   // the MCU was reset by the watchdog, counted at boot
+  RN_FAULT_RX_TIMEOUT, // no line from the module before the MCU side deadline
+  RN_FAULT_NO_ANSWER,  // the module did not answer "sys get hweui"
+  RN_FAULT_COUNT
+};
+
+enum rn_recovery {
+  RN_RECOVER_NONE,
+  RN_RECOVER_REARM,       // stop rx and drain the UART, the next receive re-arms
+  RN_RECOVER_RECONFIGURE, // rerun the module setup commands
+  RN_RECOVER_RESET_RADIO, // pulse the reset pin and set the module up again
+  RN_RECOVER_RESET_MCU,   // let the watchdog reset the MCU
+  RN_RECOVER_COUNT
+};
+
+// What the node was doing, recorded with every fault
+enum rn_phase {
+  RN_PHASE_BOOT,
+  RN_PHASE_RADIO_SETUP,
+  RN_PHASE_RECEIVE,
+  RN_PHASE_SEND,
+  RN_PHASE_LISTEN,
+  RN_PHASE_LOOP,  // role logic between radio calls
+  RN_PHASE_REBOOT // the supervisor itself reset the MCU
+};
+
+struct rn_fault_log {
+  uint16_t magic;
+  uint16_t boots;
+  uint16_t faults[RN_FAULT_COUNT];         // saturate at 0xFFFF
+  uint16_t recoveries[RN_RECOVER_COUNT];
+  uint8_t last_fault;
+  uint8_t last_phase;
+  uint8_t checksum;
+};
+
+struct rn_supervisor {
+  rn_fault_log log;
+  uint8_t phase;    // set by the radio and the roles as they go
+  uint8_t streak;   // recovery tier reached by the faults in a row
+  bool rebooted;    // the MCU was reset during this streak
+  bool dirty;       // log changed since it was last written to EEPROM
+};
+
+// True if the record has the current magic and a matching checksum
+bool rn_fault_log_valid(const rn_fault_log *log);
+
+// Starts from a stored record, or from zero if stored is NULL or not valid
+void rn_supervisor_init(rn_supervisor *s, const rn_fault_log *stored);
+
+// Counts a boot, and a watchdog fault in the phase recorded before it
+void rn_supervisor_boot(rn_supervisor *s, bool watchdog_reset);
+
+// Counts a fault and returns the recovery to run for it
+rn_recovery rn_supervisor_fault(rn_supervisor *s, rn_fault fault);
+
+// The module answered, ends the streak. True if the log should be saved now.
+bool rn_supervisor_ok(rn_supervisor *s);
+
+/*
+ * Telemetry field "<tag>:<boots>.<watchdog>.<rx timeouts>.<no answer>.
+ * <radio resets>.<MCU resets>.<last phase>", e.g. "FD:3.1.4.0.1.0.2".
+ * Returns its length, 0 if it does not fit capacity.
+ */
+size_t rn_supervisor_format(const rn_supervisor *s, const char *tag, char *buf, size_t capacity);
+
+#ifdef ARDUINO
+
+// Watchdog period, the longest the AVR offers
+#ifndef RN_SUPERVISOR_WDT
+#define RN_SUPERVISOR_WDT WDTO_8S
+#endif
+
+/*
+ * Reads the reset cause, restores the record from .noinit RAM or EEPROM,
+ * counts the boot and starts the watchdog. The state lives outside the
+ * node object so the C runtime does not clear it on a watchdog reset.
+ */
+rn_supervisor *rn_supervisor_begin();
+
+void rn_supervisor_feed();
+
+// delay() that keeps feeding the watchdog
+void rn_supervisor_delay(unsigned long ms);
+
+// Writes the record to EEPROM, only the bytes that changed
+void rn_supervisor_save(rn_supervisor *s);
+
+// Saves the record and lets the watchdog reset the MCU
+void rn_supervisor_reboot(rn_supervisor *s);
+
+#endif
+#endif
@@ -0,0 +1,131 @@
+#if defined(ARDUINO) && defined(NODE_ROLE_TRANSMITTER)
+
+#include "rn_transmitter.h"
+#include "rn_channel.h"
+
+// The transmitter waits longer than the others, the drone may be connecting the receiver
+#define TRANSMITTER_RADIO_WDT 12000
+// Longest wait in s a DEFER from the drone is honoured for, half the idle timeout
+#define TRANSMITTER_DEFER_MAX (RN_SESSION_IDLE_TIMEOUT / 2000)
+
+Transmitter::Transmitter()
+  : succesfull_transmissions(0),
+    tried_transmissions(0),
+    full_time(0),
+    burst_start(0),
+    round_trip(0)
+{
+}
+
+void Transmitter::setup()
+{
+  start(RN_CHANNEL_UPLINK_RENDEZVOUS, TRANSMITTER_RADIO_WDT);
+  rn_session_init(&session);
+  delay(2000);
+}
+
+void Transmitter::read_sensor_blob()
+{
+#if SENSOR_BLOB_SIZE > 0
+  for (size_t i = 0; i + 1 < SENSOR_BLOB_SIZE; i += 2){
+    int sample = analogRead(A0);
+    sensor_blob[i] = sample & 0xFF;
+    sensor_blob[i + 1] = sample >> 8;
+  }
+#endif
+}
+
+bool Transmitter::send_packets()
+{
+  burst_start = millis();
+  String packet = "P/" + String(session.tx_seq + 1) + ",RT:" + String(round_trip) + telemetry("FT");
+  if (!send_burst(packet)){
+    // Nothing went out, give the budget time to refill
+    rn_supervisor_delay(1000);
+    return false;
+  }
+  ++ session.tx_seq;
+  ++ tried_transmissions;
+  return true;
+}
+
+void Transmitter::loop()
+{
+  if(full_time == 0){
+    full_time = millis();
+  }
+
+  rn_session_poll(&session, millis());
+  while (!rn_session_established(&session))
+  { status_led_connected(false);
+    Serial.println(String(F("Establishing connection ")) +String(triedConnIndex) + F(" times"));
+    // Resumes a suspended session if the drone still knows it, otherwise connects anew
+    connection_request(&session, RN_CHANNEL_UPLINK_RENDEZVOUS, RN_CHANNEL_NONE);
+  }
+
+  // Start sending packets
+  status_led_connected(true);
+  tune(&session, RN_CHANNEL_UPLINK_RENDEZVOUS);
+  conf = "";
+  if(send_packets()){
+
+    Serial.println(F("Waiting for received confirmation"));
+    conf = radio.receive();
+    if (message_type(conf) == RN_MSG_HOP){
+      // The drone moves this hop ahead of the confirmation, tune() follows on the next pass
+      rn_session_message(&session, (const uint8_t *)conf.c_str(), conf.length(), millis());
+      Serial.println(String(F("Hopping to channel ")) + String(session.channel));
+      conf = radio.receive();
+    }
+    Serial.println(String(F("conf: ")) + conf);
+
+    uint32_t confirmed = 0;
+    if (message_type(conf) == RN_MSG_PACKET &&
+        rn_field_uint((const uint8_t *)conf.c_str(), conf.length(), 1, &confirmed) &&
+        (uint16_t)confirmed == session.tx_seq){
+      round_trip = millis() - burst_start;
+      rn_session_event(&session, RN_EV_FRAME, 0, millis());
+      ++ succesfull_transmissions;
+      Serial.println(conf);
+      Serial.println(String(F("Succesfully send. Succesfull transmissions: "))+ String(succesfull_transmissions) + F(", Tried transmissions: ")  + String(tried_transmissions));
+#if SENSOR_BLOB_SIZE > 0
+      if (!blob_busy()){
+        read_sensor_blob();
+        start_blob(sensor_blob, SENSOR_BLOB_SIZE);
+      }
+#endif
+    }
+    else if (message_type(conf) == RN_MSG_DEFER){
+      // The drone is there but its budget held the burst back, wait instead of counting a miss
+      uint32_t seconds = 0;
+      rn_session_message(&session, (const uint8_t *)conf.c_str(), conf.length(), millis());
+      rn_field_uint((const uint8_t *)conf.c_str(), conf.length(), 1, &seconds);
+      seconds = seconds < TRANSMITTER_DEFER_MAX ? seconds : TRANSMITTER_DEFER_MAX;
+      Serial.println(String(F("Burst deferred by the drone for ")) + String(seconds) + F(" s"));
+      // The burst never left the drone, its sequence number goes out again
+      -- session.tx_seq;
+      -- tried_transmissions;
+      rn_supervisor_delay(seconds * 1000UL);
+    }
+    else{
+      // Nothing, or the confirmation of an earlier burst arriving late
+      Serial.println(String(F("Failed to get confirmation. Tried transmissions: ")) + String(tried_transmissions));
+      rn_session_event(&session, RN_EV_MISS, 0, millis());
+      status_led_connected(rn_session_established(&session));
+    }
+  }
+
+#if SENSOR_BLOB_SIZE > 0
+  // One fragment per pass, the bursts and whatever the drone says go in between
+  if (blob_busy() && rn_session_established(&session)){
+    tune(&session, RN_CHANNEL_UPLINK_RENDEZVOUS);
+    String heard;
+    blob_step(&heard);
+    if (heard.length() > 0){
+      rn_session_message(&session, (const uint8_t *)heard.c_str(), heard.length(), millis());
+    }
+  }
+#endif
+}
+
+#endif
@@ -0,0 +1,47 @@
+/*
+ * Transmitter role: opens the session with the drone and sends a
+ * START, P/<n>, END burst every round, waiting for the receiver's
+ * confirmation relayed back by the drone. Each packet carries ",RT:<ms>",
+ * how long the previous burst took from START to its confirmation.
+ */
+#ifndef RN_TRANSMITTER_H
+#define RN_TRANSMITTER_H
+
+#ifdef ARDUINO
+
+#include "rn_node.h"
+
+// Bytes of A0 samples sent as a fragmented blob after every burst, 0 disables it
+#ifndef SENSOR_BLOB_SIZE
+#define SENSOR_BLOB_SIZE 0
+#endif
+
+class Transmitter : public Node {
+public:
+  Transmitter();
+
+  void setup();
+  void loop();
+
+private:
+  // Sends the burst, false if the duty cycle budget skipped it
+  bool send_packets();
+  void read_sensor_blob();
+
+  rn_session session;
+
+  int succesfull_transmissions;
+  int tried_transmissions;
+  unsigned long full_time;
+  unsigned long burst_start;
+  unsigned long round_trip; // ms of the last confirmed burst, 0 before the first
+
+  String conf;
+
+#if SENSOR_BLOB_SIZE > 0
+  uint8_t sensor_blob[SENSOR_BLOB_SIZE];
+#endif
+};
+
+#endif
+#endif
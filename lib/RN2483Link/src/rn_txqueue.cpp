@@ -0,0 +1,192 @@
+#include "rn_txqueue.h"
+
+#include <string.h>
+
+// Symbol time in us, 16.4 ms at SF12/250 kHz
+#define RN_AIR_SYMBOL_US ((1UL << RN_AIR_SF) * 1000UL / RN_AIR_BW_KHZ)
+// Low data rate optimisation is on for symbols of 16 ms and longer
+#define RN_AIR_LDRO      (RN_AIR_SYMBOL_US >= 16000UL ? 1 : 0)
+
+static const uint32_t ttls[RN_TX_CLASS_COUNT] = {
+  RN_TXQ_CONTROL_TTL,   // RN_TX_CONTROL
+  RN_TXQ_TELEMETRY_TTL, // RN_TX_TELEMETRY
+  RN_TXQ_BULK_TTL       // RN_TX_BULK
+};
+
+
+uint32_t rn_airtime(size_t len)
+{
+  // Semtech's formula for an explicit header with CRC, in quarter symbols
+  long bits = 8L * (long)len - 4 * RN_AIR_SF + 28 + 16;
+  long per_block = 4 * (RN_AIR_SF - 2 * RN_AIR_LDRO);
+  long blocks = bits > 0 ? (bits + per_block - 1) / per_block : 0;
+  uint32_t quarters = RN_AIR_PREAMBLE * 4 + 17 + 4 * (8 + blocks * (RN_AIR_CR + 4));
+  return (quarters * RN_AIR_SYMBOL_US / 4 + 999) / 1000;
+}
+
+// Credit in us a class has to leave in the bucket
+static uint32_t floor_of(uint8_t cls)
+{
+  return cls == RN_TX_CONTROL ? 0 : RN_TXQ_CONTROL_RESERVE * 1000UL;
+}
+
+void rn_txq_init(rn_txqueue *q, uint32_t now)
+{
+  memset(q, 0, sizeof(*q));
+  q->credit = RN_TXQ_BUDGET * 1000UL;
+  q->refilled = now;
+}
+
+static void refill(rn_txqueue *q, uint32_t now)
+{
+  const uint32_t capacity = RN_TXQ_BUDGET * 1000UL;
+  uint32_t elapsed = now - q->refilled;
+  q->refilled = now;
+  // elapsed ms at the duty cycle earn elapsed * permille us, stop before that overflows
+  if (elapsed >= capacity / RN_TXQ_DUTY_PERMILLE) {
+    q->credit = capacity;
+    return;
+  }
+  q->credit += elapsed * RN_TXQ_DUTY_PERMILLE;
+  if (q->credit > capacity) {
+    q->credit = capacity;
+  }
+}
+
+static uint16_t offset_of(const rn_txqueue *q, uint8_t index)
+{
+  uint16_t offset = 0;
+  for (uint8_t i = 0; i < index; ++i) {
+    offset += q->entries[i].len;
+  }
+  return offset;
+}
+
+static void remove_entry(rn_txqueue *q, uint8_t index)
+{
+  uint16_t offset = offset_of(q, index);
+  uint8_t len = q->entries[index].len;
+  memmove(q->data + offset, q->data + offset + len, q->used - offset - len);
+  q->used -= len;
+  memmove(&q->entries[index], &q->entries[index + 1], (q->count - index - 1) * sizeof(rn_txq_entry));
+  --q->count;
+}
+
+bool rn_txq_push(rn_txqueue *q, rn_tx_class cls, const uint8_t *data, size_t len, uint32_t now)
+{
+  if (cls >= RN_TX_CLASS_COUNT || len > 0xFF || len > RN_TXQ_BYTES) {
+    return false;
+  }
+  while (q->count == RN_TXQ_SLOTS || q->used + len > RN_TXQ_BYTES) {
+    // Make room by pushing out the oldest bulk frame, bulk never pushes out anything
+    uint8_t victim = 0;
+    while (victim < q->count && q->entries[victim].cls != RN_TX_BULK) {
+      ++victim;
+    }
+    if (cls == RN_TX_BULK || victim == q->count) {
+      return false;
+    }
+    remove_entry(q, victim);
+    ++q->dropped[RN_TX_BULK];
+  }
+
+  rn_txq_entry *entry = &q->entries[q->count++];
+  entry->cls = cls;
+  entry->len = (uint8_t)len;
+  entry->queued = now;
+  memcpy(q->data + q->used, data, len);
+  q->used += len;
+  return true;
+}
+
+int rn_txq_next(rn_txqueue *q, uint32_t now)
+{
+  refill(q, now);
+
+  uint8_t index = 0;
+  while (index < q->count) {
+    const rn_txq_entry *entry = &q->entries[index];
+    if (ttls[entry->cls] > 0 && now - entry->queued >= ttls[entry->cls]) {
+      ++q->dropped[entry->cls];
+      remove_entry(q, index);
+    }
+    else {
+      ++index;
+    }
+  }
+
+  // Highest class first, aged bulk counts as telemetry, the oldest of a class first
+  int best = -1;
+  uint8_t best_cls = RN_TX_CLASS_COUNT;
+  for (uint8_t i = 0; i < q->count; ++i) {
+    uint8_t cls = q->entries[i].cls;
+    if (cls == RN_TX_BULK && now - q->entries[i].queued >= RN_TXQ_AGING) {
+      cls = RN_TX_TELEMETRY;
+    }
+    if (cls < best_cls) {
+      best = i;
+      best_cls = cls;
+    }
+  }
+
+  // A frame the budget holds back is not overtaken by a lower class
+  if (best >= 0 && q->credit < floor_of(q->entries[best].cls) + rn_airtime(q->entries[best].len) * 1000UL) {
+    return -1;
+  }
+  return best;
+}
+
+const uint8_t *rn_txq_frame(const rn_txqueue *q, uint8_t index, size_t *len)
+{
+  *len = q->entries[index].len;
+  return q->data + offset_of(q, index);
+}
+
+void rn_txq_sent(rn_txqueue *q, uint8_t index, uint32_t now)
+{
+  uint32_t cost = rn_airtime(q->entries[index].len) * 1000UL;
+  refill(q, now);
+  q->credit = q->credit > cost ? q->credit - cost : 0;
+  ++q->sent[q->entries[index].cls];
+  remove_entry(q, index);
+}
+
+bool rn_txq_affordable(rn_txqueue *q, rn_tx_class cls, uint32_t airtime, uint32_t now)
+{
+  refill(q, now);
+  return q->credit >= floor_of(cls) + airtime * 1000UL;
+}
+
+uint32_t rn_txq_wait(rn_txqueue *q, rn_tx_class cls, uint32_t airtime, uint32_t now)
+{
+  refill(q, now);
+  uint32_t needed = floor_of(cls) + airtime * 1000UL;
+  if (q->credit >= needed) {
+    return 0;
+  }
+  // The bucket earns RN_TXQ_DUTY_PERMILLE us per ms
+  return (needed - q->credit + RN_TXQ_DUTY_PERMILLE - 1) / RN_TXQ_DUTY_PERMILLE;
+}
+
+uint8_t rn_txq_pending(const rn_txqueue *q, rn_tx_class cls)
+{
+  uint8_t pending = 0;
+  for (uint8_t i = 0; i < q->count; ++i) {
+    pending += q->entries[i].cls == cls;
+  }
+  return pending;
+}
+
+void rn_txq_drop(rn_txqueue *q, rn_tx_class cls)
+{
+  uint8_t index = 0;
+  while (index < q->count) {
+    if (q->entries[index].cls == cls) {
+      ++q->dropped[cls];
+      remove_entry(q, index);
+    }
+    else {
+      ++index;
+    }
+  }
+}
@@ -0,0 +1,149 @@
+/*
+ * Transmit queue shared by every node role.
+ *
+ * Frames are queued in one of three classes and sent highest class first:
+ *
+ *   control    session handshakes, HOP, fragment acks and the burst
+ *              confirmations, short and waited on by a peer
+ *   telemetry  the START, P/<n>, END bursts
+ *   bulk       fragments of a blob
+ *
+ * Within a class frames go out in the order they were queued. A bulk frame
+ * that has waited RN_TXQ_AGING ms is scheduled like telemetry, so a steady
+ * stream of bursts cannot starve a blob. Nothing ages into control.
+ *
+ * Airtime comes out of a token bucket that refills at the duty cycle of
+ * the band (1% by default) and holds at most RN_TXQ_BUDGET ms. Telemetry
+ * and bulk may not dip into the airtime of the largest control frame,
+ * RN_TXQ_CONTROL_MAX bytes, so however much bulk data is queued and however
+ * little budget is left, a control frame waits at most for the frame
+ * already on the air and the turnaround gap. A frame still queued after
+ * the time to live of its class is dropped unsent rather than sent late.
+ *
+ * The node sends the frame rn_txq_next() picks, then reports it with
+ * rn_txq_sent(). All of this is plain C, time is passed in as millis().
+ */
+#ifndef RN_TXQUEUE_H
+#define RN_TXQUEUE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "rn_frame.h"
+
+// Frames and payload bytes the queue holds. With the default size one
+// frame of RN_MAX_PAYLOAD bytes always fits into an empty queue, the UNO
+// transmitter sets a smaller one for its short frames.
+#ifndef RN_TXQ_SLOTS
+#define RN_TXQ_SLOTS 8
+#endif
+#ifndef RN_TXQ_BYTES
+#define RN_TXQ_BYTES 256
+#endif
+
+// Share of the time the node may be on the air, in per mille
+#ifndef RN_TXQ_DUTY_PERMILLE
+#define RN_TXQ_DUTY_PERMILLE 10
+#endif
+// Airtime in ms the bucket holds, 1% of an hour
+#ifndef RN_TXQ_BUDGET
+#define RN_TXQ_BUDGET 36000UL
+#endif
+// Bytes of the largest control frame, the receiver's confirmation can be
+// as long as anything the radio sends
+#ifndef RN_TXQ_CONTROL_MAX
+#ifdef RN_RADIO_PAYLOAD_MAX
+#define RN_TXQ_CONTROL_MAX RN_RADIO_PAYLOAD_MAX
+#else
+#define RN_TXQ_CONTROL_MAX RN_MAX_PAYLOAD
+#endif
+#endif
+// Airtime in ms only control frames may use, 7 s at the defaults
+#define RN_TXQ_CONTROL_RESERVE rn_airtime(RN_TXQ_CONTROL_MAX)
+
+// ms a bulk frame waits before it is scheduled like telemetry
+#ifndef RN_TXQ_AGING
+#define RN_TXQ_AGING 5000UL
+#endif
+// ms after which a queued frame is dropped unsent, 0 keeps it until sent.
+// A control frame answers a peer that listens for one receive window, the
+// transmitter's 12 s being the longest.
+#ifndef RN_TXQ_CONTROL_TTL
+#define RN_TXQ_CONTROL_TTL 12000UL
+#endif
+#ifndef RN_TXQ_TELEMETRY_TTL
+#define RN_TXQ_TELEMETRY_TTL 30000UL
+#endif
+#ifndef RN_TXQ_BULK_TTL
+#define RN_TXQ_BULK_TTL 10000UL
+#endif
+
+// ms between the end of the last frame on the air, sent or received, and
+// the next transmission, so the peer has re-armed its receiver
+#ifndef RN_TXQ_GAP
+#define RN_TXQ_GAP 200UL
+#endif
+
+// LoRa settings the airtime is worked out for, as set in Radio::configure()
+#define RN_AIR_SF       12
+#define RN_AIR_BW_KHZ   250
+#define RN_AIR_CR       4  // 4/8
+#define RN_AIR_PREAMBLE 8
+
+enum rn_tx_class {
+  RN_TX_CONTROL,
+  RN_TX_TELEMETRY,
+  RN_TX_BULK,
+  RN_TX_CLASS_COUNT
+};
+
+struct rn_txq_entry {
+  uint8_t cls;
+  uint8_t len;
+  uint32_t queued; // millis() when queued
+};
+
+struct rn_txqueue {
+  rn_txq_entry entries[RN_TXQ_SLOTS]; // in the order queued
+  uint8_t count;
+  uint16_t used;                      // bytes of data in use
+  uint8_t data[RN_TXQ_BYTES];         // payloads back to back, in entry order
+  uint32_t credit;                    // airtime left, in us
+  uint32_t refilled;                  // millis() of the last refill
+  uint16_t sent[RN_TX_CLASS_COUNT];
+  uint16_t dropped[RN_TX_CLASS_COUNT]; // stale, or pushed out by a higher class
+};
+
+// Airtime in ms of a payload of len bytes
+uint32_t rn_airtime(size_t len);
+
+// Empty queue with a full budget
+void rn_txq_init(rn_txqueue *q, uint32_t now);
+
+// Queues a frame. If the queue is full, control and telemetry push out the
+// oldest bulk frames. Returns false if the frame does not fit.
+bool rn_txq_push(rn_txqueue *q, rn_tx_class cls, const uint8_t *data, size_t len, uint32_t now);
+
+// Drops stale frames and returns the index of the frame to send now, or -1
+// if the queue is empty or the budget holds back everything queued
+int rn_txq_next(rn_txqueue *q, uint32_t now);
+
+// Payload of a queued frame, valid until the queue changes
+const uint8_t *rn_txq_frame(const rn_txqueue *q, uint8_t index, size_t *len);
+
+// The frame at index went out, takes it off the queue and charges its airtime
+void rn_txq_sent(rn_txqueue *q, uint8_t index, uint32_t now);
+
+// True if a class may spend airtime ms now
+bool rn_txq_affordable(rn_txqueue *q, rn_tx_class cls, uint32_t airtime, uint32_t now);
+
+// ms until a class may spend airtime ms, 0 if it may now
+uint32_t rn_txq_wait(rn_txqueue *q, rn_tx_class cls, uint32_t airtime, uint32_t now);
+
+// Frames of a class still queued
+uint8_t rn_txq_pending(const rn_txqueue *q, rn_tx_class cls);
+
+// Drops every frame of a class
+void rn_txq_drop(rn_txqueue *q, rn_tx_class cls);
+
+#endif
@@ -0,0 +1,118 @@
+#include "rn_uplink.h"
+
+#include <string.h>
+
+uint16_t rn_crc16(const uint8_t *data, size_t len)
+{
+  uint16_t crc = 0xFFFF;
+  for (size_t i = 0; i < len; ++i) {
+    crc ^= (uint16_t)data[i] << 8;
+    for (int bit = 0; bit < 8; ++bit) {
+      crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
+    }
+  }
+  return crc;
+}
+
+size_t rn_uplink_encode(const rn_uplink_record *record, uint8_t *frame)
+{
+  uint8_t raw[RN_UPLINK_RECORD_MAX];
+  size_t len = 0;
+  raw[len++] = RN_UPLINK_VERSION;
+  raw[len++] = (uint8_t)record->millis;
+  raw[len++] = (uint8_t)(record->millis >> 8);
+  raw[len++] = (uint8_t)(record->millis >> 16);
+  raw[len++] = (uint8_t)(record->millis >> 24);
+  raw[len++] = (uint8_t)record->snr;
+  raw[len++] = record->channel;
+  raw[len++] = record->length;
+  memcpy(raw + len, record->payload, record->length);
+  len += record->length;
+  uint16_t crc = rn_crc16(raw, len);
+  raw[len++] = (uint8_t)crc;
+  raw[len++] = (uint8_t)(crc >> 8);
+
+  // COBS: every zero becomes the distance to the next one, a code byte per 254 at most
+  size_t out = 0;
+  frame[out++] = 0;
+  size_t code_at = out++;
+  uint8_t code = 1;
+  for (size_t i = 0; i < len; ++i) {
+    if (raw[i] != 0) {
+      frame[out++] = raw[i];
+      ++code;
+    }
+    if (raw[i] == 0 || code == 0xFF) {
+      frame[code_at] = code;
+      code_at = out++;
+      code = 1;
+    }
+  }
+  frame[code_at] = code;
+  frame[out++] = 0;
+  return out;
+}
+
+void rn_uplink_decoder_init(rn_uplink_decoder *decoder)
+{
+  decoder->length = 0;
+  decoder->overflow = false;
+}
+
+// Undoes COBS in place, returns the decoded length or 0 if the frame is broken
+static size_t cobs_decode(uint8_t *data, size_t len)
+{
+  size_t in = 0;
+  size_t out = 0;
+  while (in < len) {
+    uint8_t code = data[in++];
+    if (code == 0 || in + code - 1 > len) {
+      return 0;
+    }
+    for (uint8_t i = 1; i < code; ++i) {
+      data[out++] = data[in++];
+    }
+    if (code != 0xFF && in < len) {
+      data[out++] = 0;
+    }
+  }
+  return out;
+}
+
+static bool parse_record(uint8_t *data, size_t len, rn_uplink_record *record)
+{
+  len = cobs_decode(data, len);
+  if (len < RN_UPLINK_HEADER + 2 || data[0] != RN_UPLINK_VERSION
+      || (size_t)RN_UPLINK_HEADER + data[7] + 2 != len) {
+    return false;
+  }
+  uint16_t crc = (uint16_t)(data[len - 2] | (data[len - 1] << 8));
+  if (rn_crc16(data, len - 2) != crc) {
+    return false;
+  }
+
+  record->millis = (uint32_t)data[1] | ((uint32_t)data[2] << 8)
+                 | ((uint32_t)data[3] << 16) | ((uint32_t)data[4] << 24);
+  record->snr = (int8_t)data[5];
+  record->channel = data[6];
+  record->length = data[7];
+  memcpy(record->payload, data + RN_UPLINK_HEADER, record->length);
+  return true;
+}
+
+bool rn_uplink_feed(rn_uplink_decoder *decoder, uint8_t byte, rn_uplink_record *record)
+{
+  if (byte != 0) {
+    if (decoder->length < sizeof(decoder->data)) {
+      decoder->data[decoder->length++] = byte;
+    } else {
+      decoder->overflow = true;
+    }
+    return false;
+  }
+
+  bool complete = decoder->length > 0 && !decoder->overflow
+               && parse_record(decoder->data, decoder->length, record);
+  rn_uplink_decoder_init(decoder);
+  return complete;
+}
@@ -0,0 +1,66 @@
+/*
+ * Binary uplink from the receiver to a host on its USB serial port.
+ *
+ * Every payload the receiver hears goes out as one record: receiver
+ * millis(), its SNR and channel, and the payload bytes, followed by a
+ * CRC-16/CCITT. The record is COBS encoded, so it contains no zero byte,
+ * and a zero byte is sent before and after it. The debug text the node
+ * prints on the same port never contains a zero byte either, so whatever
+ * lies between two zeros is either a whole record or text, and text fails
+ * the COBS or CRC check and is dropped. A host that opens the port in the
+ * middle of a record loses only that record.
+ *
+ * The encoder runs on the receiver, the decoder in tools/ on the host.
+ */
+#ifndef RN_UPLINK_H
+#define RN_UPLINK_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "rn_frame.h"
+
+// Baud rate of the receiver's serial port while the uplink is on
+#ifndef RN_UPLINK_BAUD
+#define RN_UPLINK_BAUD 500000UL
+#endif
+
+#define RN_UPLINK_VERSION 1
+
+// version, millis (4), snr, channel, length, payload, crc (2)
+#define RN_UPLINK_HEADER     8
+#define RN_UPLINK_RECORD_MAX (RN_UPLINK_HEADER + RN_MAX_PAYLOAD + 2)
+// COBS adds a byte per 254 and the two delimiters
+#define RN_UPLINK_FRAME_MAX  (RN_UPLINK_RECORD_MAX + RN_UPLINK_RECORD_MAX / 254 + 3)
+
+struct rn_uplink_record {
+  uint32_t millis;   // receiver clock when the payload was heard
+  int8_t snr;        // receiver's SNR of the payload
+  uint8_t channel;   // channel it was heard on
+  uint8_t length;
+  uint8_t payload[RN_MAX_PAYLOAD];
+};
+
+struct rn_uplink_decoder {
+  uint16_t length;   // bytes collected since the last zero
+  bool overflow;     // more than a frame since the last zero, drop it
+  uint8_t data[RN_UPLINK_RECORD_MAX + RN_UPLINK_RECORD_MAX / 254 + 1];
+};
+
+uint16_t rn_crc16(const uint8_t *data, size_t len);
+
+/*
+ * Encodes one record into frame, zero delimiters included. frame must hold
+ * RN_UPLINK_FRAME_MAX bytes. Returns the frame length.
+ */
+size_t rn_uplink_encode(const rn_uplink_record *record, uint8_t *frame);
+
+void rn_uplink_decoder_init(rn_uplink_decoder *decoder);
+
+/*
+ * Feeds one byte from the serial stream. Returns true when it completed a
+ * valid record, which is then stored in record.
+ */
+bool rn_uplink_feed(rn_uplink_decoder *decoder, uint8_t byte, rn_uplink_record *record);
+
+#endif
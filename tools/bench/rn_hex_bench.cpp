@@ -0,0 +1,163 @@
+/*
+ * Micro-benchmark of the hex codecs.
+ *
+ *   rn_hex_bench [megabytes]
+ *
+ * Compares three ways of getting a payload to and from "radio tx" /
+ * "radio_rx" hex:
+ *
+ *   rn2xx3  what base16encode()/base16decode() do: a String append of a
+ *           sprintf("%02X") per byte, and a strtol() per digit pair,
+ *           redone here with std::string since the library is Arduino only
+ *   device  rn_hex_encode()/rn_hex_decode() from lib/RN2483Link, in place
+ *   host    rn_host_hex_encode()/rn_host_hex_decode(), in place
+ *
+ * Every codec is checked against the others before it is timed. Reports
+ * the best of five runs in MB/s of payload bytes.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include "rn_frame.h"
+#include "rn_hex_host.h"
+
+static std::string rn2xx3_encode(const std::string &input)
+{
+  std::string output;
+  char chars_out[3];
+  for (size_t i = 0; i < input.length(); ++i) {
+    sprintf(chars_out, "%02X", (unsigned char)input[i]);
+    output += chars_out;
+  }
+  return output;
+}
+
+static std::string rn2xx3_decode(const std::string &input)
+{
+  std::string output;
+  char byte_in[3] = {0, 0, 0};
+  for (size_t i = 0; i + 1 < input.length(); i += 2) {
+    byte_in[0] = input[i];
+    byte_in[1] = input[i + 1];
+    output += (char)strtol(byte_in, NULL, 16);
+  }
+  return output;
+}
+
+template <typename F>
+static double best_seconds(F run)
+{
+  double best = 1e9;
+  for (int round = 0; round < 5; ++round) {
+    auto start = std::chrono::steady_clock::now();
+    run();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    if (seconds < best) {
+      best = seconds;
+    }
+  }
+  return best;
+}
+
+static void report(const char *name, size_t bytes, double encode, double decode)
+{
+  printf("%-8s encode %9.1f MB/s   decode %9.1f MB/s\n", name, bytes / encode / 1e6, bytes / decode / 1e6);
+}
+
+// The payloads are cut into radio sized pieces like a trace would be
+static const size_t chunk = RN_MAX_PAYLOAD;
+
+int main(int argc, char **argv)
+{
+  size_t megabytes = argc > 1 ? strtoul(argv[1], NULL, 10) : 64;
+  size_t bytes = (megabytes > 0 ? megabytes : 1) << 20;
+  bytes -= bytes % chunk;
+
+  std::vector<uint8_t> payload(bytes);
+  srand(1);
+  for (size_t i = 0; i < bytes; ++i) {
+    payload[i] = (uint8_t)rand();
+  }
+
+  // Reference result, and a buffer big enough to encode every chunk in place
+  std::vector<char> expected(2 * bytes + 1);
+  for (size_t i = 0; i < bytes; i += chunk) {
+    rn_hex_encode(&payload[i], chunk, &expected[2 * i]);
+  }
+  std::vector<char> work(2 * bytes + 1);
+
+  // rn2xx3, on a sixteenth of the data, it is slow
+  size_t library_bytes = bytes / 16 - (bytes / 16) % chunk;
+  std::vector<std::string> texts;
+  std::vector<std::string> hexes;
+  for (size_t i = 0; i < library_bytes; i += chunk) {
+    texts.push_back(std::string((const char *)&payload[i], chunk));
+  }
+  for (size_t i = 0; i < texts.size(); ++i) {
+    hexes.push_back(rn2xx3_encode(texts[i]));
+    if (memcmp(hexes[i].data(), &expected[2 * i * chunk], 2 * chunk) != 0 || rn2xx3_decode(hexes[i]) != texts[i]) {
+      fprintf(stderr, "rn2xx3 codec mismatch\n");
+      return 1;
+    }
+  }
+  size_t sink = 0;
+  double encode = best_seconds([&] {
+    for (size_t i = 0; i < texts.size(); ++i) {
+      sink += rn2xx3_encode(texts[i]).length();
+    }
+  });
+  double decode = best_seconds([&] {
+    for (size_t i = 0; i < hexes.size(); ++i) {
+      sink += rn2xx3_decode(hexes[i]).length();
+    }
+  });
+  report("rn2xx3", library_bytes, encode, decode);
+
+  // The two in place codecs, each chunk copied into work then encoded and decoded in place
+  struct codec {
+    const char *name;
+    size_t (*encode)(const uint8_t *, size_t, char *);
+    bool (*decode)(const char *, size_t, uint8_t *);
+  };
+  const codec codecs[] = {
+    { "device", rn_hex_encode, rn_hex_decode },
+    { "host", rn_host_hex_encode, rn_host_hex_decode },
+  };
+  for (const codec &c : codecs) {
+    for (size_t i = 0; i < bytes; i += chunk) {
+      memcpy(&work[2 * i], &payload[i], chunk);
+      c.encode((const uint8_t *)&work[2 * i], chunk, &work[2 * i]);
+    }
+    if (memcmp(&work[0], &expected[0], 2 * bytes) != 0) {
+      fprintf(stderr, "%s encode mismatch\n", c.name);
+      return 1;
+    }
+    for (size_t i = 0; i < bytes; i += chunk) {
+      if (!c.decode(&work[2 * i], 2 * chunk, (uint8_t *)&work[2 * i])
+          || memcmp(&work[2 * i], &payload[i], chunk) != 0) {
+        fprintf(stderr, "%s decode mismatch\n", c.name);
+        return 1;
+      }
+    }
+
+    std::vector<uint8_t> decoded(bytes);
+    encode = best_seconds([&] {
+      for (size_t i = 0; i < bytes; i += chunk) {
+        sink += c.encode(&payload[i], chunk, &work[2 * i]);
+      }
+    });
+    decode = best_seconds([&] {
+      for (size_t i = 0; i < bytes; i += chunk) {
+        sink += c.decode(&expected[2 * i], 2 * chunk, &decoded[i]);
+      }
+    });
+    report(c.name, bytes, encode, decode);
+  }
+
+  return sink == 0;
+}
@@ -0,0 +1,240 @@
+#include "rn_column_log.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define RN_LOG_MAGIC   "RNLOG\0\0\0"
+#define RN_LOG_VERSION 1
+
+struct rn_log_meta {
+  char magic[8];
+  uint32_t version;
+  uint32_t columns;
+  uint64_t rows; // committed rows, written last
+};
+
+static const struct {
+  const char *name;
+  size_t width;
+  size_t offset; // in rn_log_row
+} column_table[RN_COL_COUNT] = {
+  { "host_ns",    8, offsetof(rn_log_row, host_ns) },
+  { "node_ms",    4, offsetof(rn_log_row, node_ms) },
+  { "seq",        4, offsetof(rn_log_row, seq) },
+  { "round_trip", 4, offsetof(rn_log_row, round_trip) },
+  { "hop1_snr",   1, offsetof(rn_log_row, hop1_snr) },
+  { "hop2_snr",   1, offsetof(rn_log_row, hop2_snr) },
+  { "channel",    1, offsetof(rn_log_row, channel) },
+};
+
+const char *rn_log_column_name(rn_log_column column)
+{
+  return column_table[column].name;
+}
+
+size_t rn_log_column_width(rn_log_column column)
+{
+  return column_table[column].width;
+}
+
+static int open_file(const char *dir, const char *name, bool writable)
+{
+  char path[PATH_MAX];
+  if (snprintf(path, sizeof(path), "%s/%s", dir, name) >= (int)sizeof(path)) {
+    errno = ENAMETOOLONG;
+    return -1;
+  }
+  return writable ? open(path, O_RDWR | O_CREAT | O_CLOEXEC, 0644) : open(path, O_RDONLY | O_CLOEXEC);
+}
+
+static void *map_file(int fd, size_t len, bool writable)
+{
+  if (len == 0) {
+    return NULL;
+  }
+  void *data = mmap(NULL, len, writable ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, fd, 0);
+  return data == MAP_FAILED ? NULL : data;
+}
+
+// Grows every column file to hold rows rows and maps it again
+static bool reserve(rn_column_log *log, uint64_t rows)
+{
+  if (rows <= log->capacity) {
+    return true;
+  }
+  uint64_t capacity = (rows + RN_LOG_GROW_ROWS - 1) / RN_LOG_GROW_ROWS * RN_LOG_GROW_ROWS;
+  for (int c = 0; c < RN_COL_COUNT; ++c) {
+    size_t old_len = log->capacity * column_table[c].width;
+    size_t new_len = capacity * column_table[c].width;
+    if (ftruncate(log->fds[c], new_len) != 0) {
+      return false;
+    }
+    void *data = log->columns[c] != NULL
+               ? mremap(log->columns[c], old_len, new_len, MREMAP_MAYMOVE)
+               : mmap(NULL, new_len, PROT_READ | PROT_WRITE, MAP_SHARED, log->fds[c], 0);
+    if (data == MAP_FAILED) {
+      return false;
+    }
+    log->columns[c] = (uint8_t *)data;
+  }
+  log->capacity = capacity;
+  return true;
+}
+
+static bool open_meta(rn_column_log *log, const char *dir)
+{
+  log->meta_fd = open_file(dir, "meta", log->writable);
+  if (log->meta_fd < 0) {
+    return false;
+  }
+  struct stat st;
+  if (fstat(log->meta_fd, &st) != 0) {
+    return false;
+  }
+  bool fresh = st.st_size == 0;
+  if (fresh && !log->writable) {
+    errno = ENODATA;
+    return false;
+  }
+  if (fresh && ftruncate(log->meta_fd, sizeof(rn_log_meta)) != 0) {
+    return false;
+  }
+  if (!fresh && (size_t)st.st_size < sizeof(rn_log_meta)) {
+    errno = EINVAL;
+    return false;
+  }
+
+  log->meta = (rn_log_meta *)map_file(log->meta_fd, sizeof(rn_log_meta), log->writable);
+  if (log->meta == NULL) {
+    return false;
+  }
+  if (fresh) {
+    memcpy(log->meta->magic, RN_LOG_MAGIC, sizeof(log->meta->magic));
+    log->meta->version = RN_LOG_VERSION;
+    log->meta->columns = RN_COL_COUNT;
+    log->meta->rows = 0;
+  }
+  if (memcmp(log->meta->magic, RN_LOG_MAGIC, sizeof(log->meta->magic)) != 0
+      || log->meta->version != RN_LOG_VERSION || log->meta->columns != RN_COL_COUNT) {
+    errno = EINVAL;
+    return false;
+  }
+  return true;
+}
+
+bool rn_column_log_open(rn_column_log *log, const char *dir, bool writable)
+{
+  memset(log, 0, sizeof(*log));
+  log->writable = writable;
+  log->meta_fd = -1;
+  for (int c = 0; c < RN_COL_COUNT; ++c) {
+    log->fds[c] = -1;
+  }
+
+  if (writable && mkdir(dir, 0755) != 0 && errno != EEXIST) {
+    return false;
+  }
+  if (!open_meta(log, dir)) {
+    rn_column_log_close(log);
+    return false;
+  }
+  log->rows = __atomic_load_n(&log->meta->rows, __ATOMIC_ACQUIRE);
+
+  for (int c = 0; c < RN_COL_COUNT; ++c) {
+    char name[32];
+    snprintf(name, sizeof(name), "%s.col", column_table[c].name);
+    log->fds[c] = open_file(dir, name, writable);
+    struct stat st;
+    if (log->fds[c] < 0 || fstat(log->fds[c], &st) != 0) {
+      rn_column_log_close(log);
+      return false;
+    }
+    // A column shorter than the row count means the log is damaged
+    uint64_t held = st.st_size / column_table[c].width;
+    if (held < log->rows) {
+      rn_column_log_close(log);
+      errno = EINVAL;
+      return false;
+    }
+    if (c == 0 || held < log->capacity) {
+      log->capacity = held;
+    }
+  }
+
+  if (writable) {
+    // Map what the files hold, reserve() grows them from there
+    uint64_t held = log->capacity;
+    log->capacity = 0;
+    if (!reserve(log, held > 0 ? held : RN_LOG_GROW_ROWS)) {
+      rn_column_log_close(log);
+      return false;
+    }
+  } else {
+    for (int c = 0; c < RN_COL_COUNT; ++c) {
+      log->columns[c] = (uint8_t *)map_file(log->fds[c], log->rows * column_table[c].width, false);
+      if (log->rows > 0 && log->columns[c] == NULL) {
+        rn_column_log_close(log);
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+bool rn_column_log_append(rn_column_log *log, const rn_log_row *rows, size_t count)
+{
+  if (!log->writable) {
+    errno = EBADF;
+    return false;
+  }
+  if (!reserve(log, log->rows + count)) {
+    return false;
+  }
+
+  for (int c = 0; c < RN_COL_COUNT; ++c) {
+    size_t width = column_table[c].width;
+    uint8_t *out = log->columns[c] + log->rows * width;
+    for (size_t r = 0; r < count; ++r) {
+      memcpy(out + r * width, (const uint8_t *)&rows[r] + column_table[c].offset, width);
+    }
+  }
+
+  // Publish the batch only once all of its columns are in place
+  log->rows += count;
+  __atomic_store_n(&log->meta->rows, log->rows, __ATOMIC_RELEASE);
+  return true;
+}
+
+const void *rn_column_log_column(const rn_column_log *log, rn_log_column column)
+{
+  return log->columns[column];
+}
+
+void rn_column_log_close(rn_column_log *log)
+{
+  for (int c = 0; c < RN_COL_COUNT; ++c) {
+    size_t mapped = (log->writable ? log->capacity : log->rows) * column_table[c].width;
+    if (log->columns[c] != NULL && mapped > 0) {
+      munmap(log->columns[c], mapped);
+    }
+    if (log->fds[c] >= 0) {
+      close(log->fds[c]);
+    }
+    log->columns[c] = NULL;
+    log->fds[c] = -1;
+  }
+  if (log->meta != NULL) {
+    munmap(log->meta, sizeof(rn_log_meta));
+    log->meta = NULL;
+  }
+  if (log->meta_fd >= 0) {
+    close(log->meta_fd);
+    log->meta_fd = -1;
+  }
+}
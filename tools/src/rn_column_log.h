@@ -0,0 +1,74 @@
+/*
+ * Append-only columnar log of the packets the gateway received.
+ *
+ * A log is a directory with one file per column, each a plain array of
+ * fixed width little-endian values, and a "meta" file holding the number
+ * of committed rows. Everything is memory mapped. The writer fills the
+ * columns of a batch first and publishes it by bumping the row count, so
+ * a reader, which maps only the rows committed when it opened the log,
+ * never sees a half written row. The files grow in steps of
+ * RN_LOG_GROW_ROWS rows; what lies past the row count is ignored and
+ * overwritten by the next append.
+ */
+#ifndef RN_COLUMN_LOG_H
+#define RN_COLUMN_LOG_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define RN_LOG_GROW_ROWS 65536
+#define RN_LOG_NO_SNR    (-128) // the hop's SNR was not in the packet
+
+enum rn_log_column {
+  RN_COL_HOST_NS,    // u64, CLOCK_REALTIME when the gateway decoded the record
+  RN_COL_NODE_MS,    // u32, receiver millis() when it heard the packet
+  RN_COL_SEQ,        // u32, sequence number from "P/<seq>"
+  RN_COL_ROUND_TRIP, // u32, "RT:" ms, the transmitter's previous burst, 0 if unknown
+  RN_COL_HOP1_SNR,   // i8, drone's SNR of the transmitter ("BS:" added by the drone)
+  RN_COL_HOP2_SNR,   // i8, receiver's SNR of the drone
+  RN_COL_CHANNEL,    // u8, channel the receiver heard it on
+  RN_COL_COUNT
+};
+
+struct rn_log_row {
+  uint64_t host_ns;
+  uint32_t node_ms;
+  uint32_t seq;
+  uint32_t round_trip;
+  int8_t hop1_snr;
+  int8_t hop2_snr;
+  uint8_t channel;
+};
+
+struct rn_log_meta;
+
+struct rn_column_log {
+  bool writable;
+  uint64_t capacity; // rows the mapped files hold
+  uint64_t rows;     // rows mapped for reading, or committed when writing
+  int meta_fd;
+  rn_log_meta *meta;
+  int fds[RN_COL_COUNT];
+  uint8_t *columns[RN_COL_COUNT];
+};
+
+// File name and width of a column
+const char *rn_log_column_name(rn_log_column column);
+size_t rn_log_column_width(rn_log_column column);
+
+/*
+ * Opens the log in directory dir. A writer creates the directory and the
+ * files if needed, a reader maps the rows committed at this point.
+ * Returns false with errno set on failure.
+ */
+bool rn_column_log_open(rn_column_log *log, const char *dir, bool writable);
+
+// Appends and commits count rows. Returns false with errno set on failure.
+bool rn_column_log_append(rn_column_log *log, const rn_log_row *rows, size_t count);
+
+// Start of a column's array, log->rows values long
+const void *rn_column_log_column(const rn_column_log *log, rn_log_column column);
+
+void rn_column_log_close(rn_column_log *log);
+
+#endif
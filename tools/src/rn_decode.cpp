@@ -0,0 +1,161 @@
+/*
+ * Decodes a capture of the RN2483 UART, e.g. from a logic analyser or a
+ * USB serial adapter tapped onto the module's TX line.
+ *
+ *   rn_decode [--stats] <capture>...
+ *
+ * Every "radio_rx  <hex>" line, timestamped by the capture tool or not,
+ * is decoded and classified with the same rn_parse_line() and
+ * rn_classify() the nodes run, then printed as
+ * "<line> <type> <payload>", non-printable bytes as \xNN. With --stats
+ * only the count per message type and the throughput are printed. The
+ * capture is mapped rather than read, so large traces are never copied.
+ */
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <chrono>
+
+#include "rn_frame.h"
+#include "rn_hex_host.h"
+
+static const char *const msg_names[] = {
+  "NONE", "CONNECT", "CONNECTED", "RESUME", "RESUMED", "REJECT", "HOP",
+  "DEFER", "START", "PACKET", "END", "FRAGMENT", "FRAG_ACK", "TEXT"
+};
+static const size_t msg_count = sizeof(msg_names) / sizeof(msg_names[0]);
+static_assert(msg_count == RN_MSG_TEXT + 1, "msg_names must name every rn_msg_type");
+
+static const char rx_word[] = "radio_rx";
+
+static void print_payload(unsigned long line, rn_msg_type type, const uint8_t *payload, size_t len)
+{
+  printf("%lu %s ", line, msg_names[type]);
+  for (size_t i = 0; i < len; ++i) {
+    if (payload[i] >= 0x20 && payload[i] < 0x7F && payload[i] != '\\') {
+      putchar(payload[i]);
+    } else {
+      printf("\\x%02X", payload[i]);
+    }
+  }
+  putchar('\n');
+}
+
+/*
+ * The hex is decoded with the host codec. Lines the fast path does not
+ * take (other spacing, odd or bad digits) go through rn_parse_line() so
+ * the verdict matches what the node would decide.
+ */
+static bool decode_line(const char *line, size_t len, uint8_t *payload, size_t *payload_len)
+{
+  size_t word = sizeof(rx_word) - 1;
+  while (len > 0 && (line[len - 1] == '\r' || line[len - 1] == ' ')) {
+    --len;
+  }
+  if (len > word + 2 && memcmp(line, rx_word, word) == 0 && line[word] == ' ' && line[word + 1] == ' ') {
+    size_t digits = len - word - 2;
+    if (digits / 2 <= RN_MAX_PAYLOAD && rn_host_hex_decode(line + word + 2, digits, payload)) {
+      *payload_len = digits / 2;
+      return true;
+    }
+  }
+  return rn_parse_line(line, len, payload, RN_MAX_PAYLOAD, payload_len) == RN_LINE_RADIO_RX;
+}
+
+static int decode_file(const char *path, bool stats, unsigned long counts[], unsigned long *malformed, size_t *bytes)
+{
+  int fd = open(path, O_RDONLY);
+  if (fd < 0) {
+    perror(path);
+    return 1;
+  }
+  struct stat st;
+  if (fstat(fd, &st) != 0) {
+    perror(path);
+    close(fd);
+    return 1;
+  }
+  if (st.st_size == 0) {
+    close(fd);
+    return 0;
+  }
+
+  const char *data = (const char *)mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (data == MAP_FAILED) {
+    perror(path);
+    return 1;
+  }
+  madvise((void *)data, st.st_size, MADV_SEQUENTIAL);
+
+  uint8_t payload[RN_MAX_PAYLOAD + 1];
+  const char *end = data + st.st_size;
+  unsigned long line_no = 0;
+  for (const char *line = data; line < end; ) {
+    const char *eol = (const char *)memchr(line, '\n', end - line);
+    const char *next = eol != NULL ? eol + 1 : end;
+    if (eol == NULL) {
+      eol = end;
+    }
+    ++line_no;
+
+    // Only module output lines can hold a payload, skip the rest cheaply
+    const char *rx = (const char *)memmem(line, eol - line, rx_word, sizeof(rx_word) - 1);
+    if (rx != NULL) {
+      size_t payload_len = 0;
+      if (decode_line(rx, eol - rx, payload, &payload_len)) {
+        rn_msg_type type = rn_classify(payload, payload_len);
+        ++counts[type];
+        if (!stats) {
+          print_payload(line_no, type, payload, payload_len);
+        }
+      } else {
+        ++*malformed;
+      }
+    }
+    line = next;
+  }
+
+  *bytes += st.st_size;
+  munmap((void *)data, st.st_size);
+  return 0;
+}
+
+int main(int argc, char **argv)
+{
+  bool stats = false;
+  int first = 1;
+  if (argc > 1 && strcmp(argv[1], "--stats") == 0) {
+    stats = true;
+    first = 2;
+  }
+  if (first >= argc) {
+    fprintf(stderr, "usage: %s [--stats] <capture>...\n", argv[0]);
+    return 2;
+  }
+
+  unsigned long counts[msg_count] = {0};
+  unsigned long malformed = 0;
+  size_t bytes = 0;
+  int status = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (int i = first; i < argc; ++i) {
+    status |= decode_file(argv[i], stats, counts, &malformed, &bytes);
+  }
+  double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+  if (stats) {
+    for (size_t type = 0; type < msg_count; ++type) {
+      if (counts[type] > 0) {
+        printf("%-10s %lu\n", msg_names[type], counts[type]);
+      }
+    }
+    printf("%-10s %lu\n", "MALFORMED", malformed);
+    printf("%zu bytes in %.3f s, %.2f GB/s\n", bytes, seconds, seconds > 0 ? bytes / seconds / 1e9 : 0.0);
+  }
+  return status;
+}
@@ -0,0 +1,267 @@
+/*
+ * Gateway daemon: reads the receiver's binary uplink and appends every
+ * packet to a columnar log.
+ *
+ *   rn_gateway [-b baud] [-n batch] <serial port or pty> <log dir>
+ *
+ * The port is put in raw mode at baud (500000 by default, RN_UPLINK_BAUD).
+ * Records are decoded with rn_uplink_feed(), the debug text around them is
+ * skipped. Each "P/<seq>" packet becomes one row with the host time, the
+ * receiver's millis(), the sequence number, the transmitter's round trip
+ * ("RT:"), the SNR of both hops and the channel. Rows are collected into
+ * batches of up to batch rows (256 by default) and committed when the
+ * batch is full or the port has been quiet for a second, so a slow disk
+ * or a burst of packets never holds up reading the port.
+ *
+ * If the port goes away (USB unplugged, simulator restarted) the daemon
+ * keeps the log open and reopens the port every second. A capture given
+ * as a file or pipe is read to its end. SIGINT and SIGTERM commit the
+ * pending batch and exit.
+ */
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <vector>
+
+#include "rn_column_log.h"
+#include "rn_frame.h"
+#include "rn_uplink.h"
+
+static volatile sig_atomic_t stopping = 0;
+
+static void stop(int)
+{
+  stopping = 1;
+}
+
+static const struct {
+  unsigned long baud;
+  speed_t speed;
+} speeds[] = {
+  { 9600, B9600 }, { 19200, B19200 }, { 38400, B38400 }, { 57600, B57600 },
+  { 115200, B115200 }, { 230400, B230400 }, { 460800, B460800 },
+  { 500000, B500000 }, { 921600, B921600 }, { 1000000, B1000000 },
+};
+
+static int open_port(const char *path, unsigned long baud, bool *tty)
+{
+  int fd = open(path, O_RDONLY | O_NOCTTY | O_CLOEXEC);
+  if (fd < 0) {
+    return -1;
+  }
+
+  // A plain file or pipe replays a capture, only a tty has a line to set up
+  struct termios tio;
+  *tty = tcgetattr(fd, &tio) == 0;
+  if (*tty) {
+    speed_t speed = 0;
+    for (size_t i = 0; i < sizeof(speeds) / sizeof(speeds[0]); ++i) {
+      if (speeds[i].baud == baud) {
+        speed = speeds[i].speed;
+      }
+    }
+    cfmakeraw(&tio);
+    tio.c_cflag |= CLOCAL | CREAD;
+    tio.c_cc[VMIN] = 0;
+    tio.c_cc[VTIME] = 0;
+    if (speed == 0 || cfsetispeed(&tio, speed) != 0 || cfsetospeed(&tio, speed) != 0
+        || tcsetattr(fd, TCSANOW, &tio) != 0) {
+      close(fd);
+      errno = EINVAL;
+      return -1;
+    }
+  }
+  return fd;
+}
+
+// Signed number after ",<tag>:" in a payload
+static bool tag_value(const uint8_t *msg, size_t len, const char *tag, long *value)
+{
+  size_t tag_len = strlen(tag);
+  for (size_t i = 0; i + tag_len + 2 < len; ++i) {
+    if (msg[i] != ',' || memcmp(msg + i + 1, tag, tag_len) != 0 || msg[i + 1 + tag_len] != ':') {
+      continue;
+    }
+    size_t pos = i + tag_len + 2;
+    bool negative = pos < len && msg[pos] == '-';
+    pos += negative;
+    if (pos >= len || msg[pos] < '0' || msg[pos] > '9') {
+      return false;
+    }
+    long result = 0;
+    while (pos < len && msg[pos] >= '0' && msg[pos] <= '9' && result < 100000000L) {
+      result = result * 10 + (msg[pos++] - '0');
+    }
+    *value = negative ? -result : result;
+    return true;
+  }
+  return false;
+}
+
+static int8_t snr_value(long snr)
+{
+  return snr < -127 ? -127 : snr > 127 ? 127 : (int8_t)snr;
+}
+
+static bool packet_row(const rn_uplink_record *record, rn_log_row *row)
+{
+  uint32_t seq = 0;
+  if (rn_classify(record->payload, record->length) != RN_MSG_PACKET
+      || !rn_field_uint(record->payload, record->length, 1, &seq)) {
+    return false;
+  }
+
+  struct timespec now;
+  clock_gettime(CLOCK_REALTIME, &now);
+  long value = 0;
+  row->host_ns = (uint64_t)now.tv_sec * 1000000000ULL + now.tv_nsec;
+  row->node_ms = record->millis;
+  row->seq = seq;
+  row->round_trip = tag_value(record->payload, record->length, "RT", &value) && value > 0 ? (uint32_t)value : 0;
+  // The drone appends the first "BS:", the receiver's own SNR comes with the record
+  row->hop1_snr = tag_value(record->payload, record->length, "BS", &value) ? snr_value(value) : RN_LOG_NO_SNR;
+  row->hop2_snr = snr_value(record->snr);
+  row->channel = record->channel;
+  return true;
+}
+
+static bool commit(rn_column_log *log, std::vector<rn_log_row> *batch)
+{
+  if (batch->empty()) {
+    return true;
+  }
+  if (!rn_column_log_append(log, batch->data(), batch->size())) {
+    perror("rn_gateway: append");
+    return false;
+  }
+  batch->clear();
+  return true;
+}
+
+int main(int argc, char **argv)
+{
+  unsigned long baud = RN_UPLINK_BAUD;
+  size_t batch_rows = 256;
+  int opt;
+  while ((opt = getopt(argc, argv, "b:n:")) != -1) {
+    switch (opt) {
+    case 'b':
+      baud = strtoul(optarg, NULL, 10);
+      break;
+    case 'n':
+      batch_rows = strtoul(optarg, NULL, 10);
+      break;
+    default:
+      optind = argc + 1;
+      break;
+    }
+  }
+  if (optind + 2 != argc || batch_rows == 0) {
+    fprintf(stderr, "usage: %s [-b baud] [-n batch] <serial port or pty> <log dir>\n", argv[0]);
+    return 2;
+  }
+  const char *port = argv[optind];
+  const char *dir = argv[optind + 1];
+
+  rn_column_log log;
+  if (!rn_column_log_open(&log, dir, true)) {
+    perror(dir);
+    return 1;
+  }
+
+  struct sigaction action;
+  memset(&action, 0, sizeof(action));
+  action.sa_handler = stop;
+  sigaction(SIGINT, &action, NULL);
+  sigaction(SIGTERM, &action, NULL);
+
+  rn_uplink_decoder decoder;
+  rn_uplink_record record;
+  std::vector<rn_log_row> batch;
+  batch.reserve(batch_rows);
+  unsigned long records = 0;
+  unsigned long packets = 0;
+  int fd = -1;
+  bool tty = false;
+  int status = 0;
+
+  while (!stopping && status == 0) {
+    if (fd < 0) {
+      fd = open_port(port, baud, &tty);
+      if (fd < 0) {
+        sleep(1);
+        continue;
+      }
+      // Whatever was half received before belongs to no record
+      rn_uplink_decoder_init(&decoder);
+      fprintf(stderr, "rn_gateway: reading %s, %llu rows in %s\n", port, (unsigned long long)log.rows, dir);
+    }
+
+    struct pollfd pfd = { fd, POLLIN, 0 };
+    int ready = poll(&pfd, 1, 1000);
+    if (ready == 0) {
+      // Quiet port, commit what there is
+      if (!commit(&log, &batch)) {
+        status = 1;
+      }
+      continue;
+    }
+    if (ready < 0) {
+      continue; // EINTR, checked by the loop
+    }
+
+    uint8_t buf[4096];
+    ssize_t got = read(fd, buf, sizeof(buf));
+    if (got < 0 && (errno == EINTR || errno == EAGAIN)) {
+      continue;
+    }
+    if (got <= 0) {
+      // Port gone, or the end of a replayed capture
+      close(fd);
+      fd = -1;
+      if (!commit(&log, &batch)) {
+        status = 1;
+      }
+      if (!tty) {
+        break;
+      }
+      continue;
+    }
+
+    for (ssize_t i = 0; i < got; ++i) {
+      if (!rn_uplink_feed(&decoder, buf[i], &record)) {
+        continue;
+      }
+      ++records;
+      batch.push_back(rn_log_row());
+      if (packet_row(&record, &batch.back())) {
+        ++packets;
+      } else {
+        batch.pop_back();
+      }
+      if (batch.size() >= batch_rows && !commit(&log, &batch)) {
+        status = 1;
+        break;
+      }
+    }
+  }
+
+  if (!commit(&log, &batch)) {
+    status = 1;
+  }
+  if (fd >= 0) {
+    close(fd);
+  }
+  fprintf(stderr, "rn_gateway: %lu records, %lu packets, %llu rows in %s\n",
+          records, packets, (unsigned long long)log.rows, dir);
+  rn_column_log_close(&log);
+  return status;
+}
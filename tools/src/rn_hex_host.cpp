@@ -0,0 +1,142 @@
+#include "rn_hex_host.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace {
+
+// Built once, the tables are cheaper to fill than to list
+struct tables {
+  char pairs[256][2];  // both digits of every byte
+  uint8_t values[256]; // 0-15, 0xFF for anything that is not a digit
+
+  tables()
+  {
+    static const char digits[] = "0123456789ABCDEF";
+    for (int i = 0; i < 256; ++i) {
+      pairs[i][0] = digits[i >> 4];
+      pairs[i][1] = digits[i & 0x0F];
+      values[i] = 0xFF;
+    }
+    for (int i = 0; i < 10; ++i) {
+      values['0' + i] = (uint8_t)i;
+    }
+    for (int i = 0; i < 6; ++i) {
+      values['A' + i] = (uint8_t)(10 + i);
+      values['a' + i] = (uint8_t)(10 + i);
+    }
+  }
+};
+
+const tables table;
+
+// Encodes [begin, end) back to front, so out may overlap in
+void encode_scalar(const uint8_t *in, size_t begin, size_t end, char *out)
+{
+  for (size_t i = end; i-- > begin; ) {
+    const char *pair = table.pairs[in[i]];
+    out[2 * i + 1] = pair[1];
+    out[2 * i] = pair[0];
+  }
+}
+
+bool decode_scalar(const char *hex, size_t begin, size_t end, uint8_t *out)
+{
+  for (size_t i = begin; i < end; i += 2) {
+    uint8_t high = table.values[(uint8_t)hex[i]];
+    uint8_t low = table.values[(uint8_t)hex[i + 1]];
+    if ((high | low) > 0x0F) {
+      return false;
+    }
+    out[i / 2] = (uint8_t)((high << 4) | low);
+  }
+  return true;
+}
+
+#if defined(__SSE2__)
+
+// Nibbles 0-15 to '0'-'9', 'A'-'F'
+inline __m128i nibble_digits(__m128i nibbles)
+{
+  __m128i letters = _mm_cmpgt_epi8(nibbles, _mm_set1_epi8(9));
+  __m128i digits = _mm_add_epi8(nibbles, _mm_set1_epi8('0'));
+  return _mm_add_epi8(digits, _mm_and_si128(letters, _mm_set1_epi8('A' - '0' - 10)));
+}
+
+// x <= limit for unsigned bytes
+inline __m128i at_most(__m128i x, uint8_t limit)
+{
+  return _mm_cmpeq_epi8(_mm_min_epu8(x, _mm_set1_epi8((char)limit)), x);
+}
+
+// 16 digits to their values, false if one of them is not a hex digit
+inline bool digit_values(__m128i chars, __m128i *values)
+{
+  __m128i numeric = _mm_sub_epi8(chars, _mm_set1_epi8('0'));
+  __m128i alpha = _mm_sub_epi8(_mm_or_si128(chars, _mm_set1_epi8(0x20)), _mm_set1_epi8('a'));
+  __m128i is_numeric = at_most(numeric, 9);
+  __m128i is_alpha = at_most(alpha, 5);
+  if (_mm_movemask_epi8(_mm_or_si128(is_numeric, is_alpha)) != 0xFFFF) {
+    return false;
+  }
+  *values = _mm_or_si128(_mm_and_si128(is_numeric, numeric),
+                         _mm_and_si128(is_alpha, _mm_add_epi8(alpha, _mm_set1_epi8(10))));
+  return true;
+}
+
+// Digit pairs (high, low) in each 16 bit lane to one byte value per lane
+inline __m128i pair_bytes(__m128i values)
+{
+  __m128i high = _mm_slli_epi16(_mm_and_si128(values, _mm_set1_epi16(0x00FF)), 4);
+  return _mm_or_si128(high, _mm_srli_epi16(values, 8));
+}
+
+#endif
+
+} // namespace
+
+size_t rn_host_hex_encode(const uint8_t *in, size_t len, char *out)
+{
+  size_t blocks = 0;
+#if defined(__SSE2__)
+  blocks = len / 16;
+#endif
+  out[2 * len] = '\0';
+  encode_scalar(in, blocks * 16, len, out);
+
+#if defined(__SSE2__)
+  // Back to front like the scalar tail, block i is loaded before it is overwritten
+  const __m128i low_nibbles = _mm_set1_epi8(0x0F);
+  for (size_t i = blocks; i-- > 0; ) {
+    __m128i bytes = _mm_loadu_si128((const __m128i *)(in + 16 * i));
+    __m128i high = nibble_digits(_mm_and_si128(_mm_srli_epi16(bytes, 4), low_nibbles));
+    __m128i low = nibble_digits(_mm_and_si128(bytes, low_nibbles));
+    _mm_storeu_si128((__m128i *)(out + 32 * i + 16), _mm_unpackhi_epi8(high, low));
+    _mm_storeu_si128((__m128i *)(out + 32 * i), _mm_unpacklo_epi8(high, low));
+  }
+#endif
+  return 2 * len;
+}
+
+bool rn_host_hex_decode(const char *hex, size_t digits, uint8_t *out)
+{
+  if (digits % 2 != 0) {
+    return false;
+  }
+
+  size_t done = 0;
+#if defined(__SSE2__)
+  // Front to back, 32 digits are loaded before their 16 bytes are stored
+  for (; done + 32 <= digits; done += 32) {
+    __m128i first;
+    __m128i second;
+    if (!digit_values(_mm_loadu_si128((const __m128i *)(hex + done)), &first)
+        || !digit_values(_mm_loadu_si128((const __m128i *)(hex + done + 16)), &second)) {
+      return false;
+    }
+    _mm_storeu_si128((__m128i *)(out + done / 2), _mm_packus_epi16(pair_bytes(first), pair_bytes(second)));
+  }
+#endif
+  return decode_scalar(hex, done, digits, out);
+}
@@ -0,0 +1,156 @@
+/*
+ * Latency and loss over time from a gateway log.
+ *
+ *   rn_query [-b bucket seconds] [-f from] [-t to] <log dir>
+ *
+ * Splits the rows between the unix times from and to (all of them by
+ * default) into buckets of bucket seconds (60 by default) of host time,
+ * and prints for each bucket:
+ *
+ *   packets  rows in the bucket
+ *   lost     sequence numbers skipped since the previous packet; a
+ *            number that does not grow starts a new transmitter session
+ *   loss     lost / (packets + lost)
+ *   rt       round trip of the transmitter's bursts ("RT:"), mean, median,
+ *            95th percentile and maximum, in ms
+ *   snr1/2   mean SNR of the transmitter -> drone and drone -> receiver hops
+ *
+ * Only the columns the query needs are read, straight from the mapped
+ * files.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <vector>
+
+#include "rn_column_log.h"
+
+struct bucket {
+  uint64_t start_s;
+  unsigned long packets;
+  unsigned long lost;
+  long snr_sum[2];
+  unsigned long snr_count[2];
+  std::vector<uint32_t> round_trips;
+};
+
+static void print_bucket(const bucket &b)
+{
+  char when[32];
+  time_t start = (time_t)b.start_s;
+  strftime(when, sizeof(when), "%Y-%m-%d %H:%M:%S", localtime(&start));
+
+  double loss = b.packets + b.lost > 0 ? 100.0 * b.lost / (b.packets + b.lost) : 0.0;
+  printf("%s %7lu %6lu %6.1f%%", when, b.packets, b.lost, loss);
+
+  std::vector<uint32_t> rt = b.round_trips;
+  if (rt.empty()) {
+    printf(" %7s %7s %7s %7s", "-", "-", "-", "-");
+  } else {
+    std::sort(rt.begin(), rt.end());
+    double sum = 0;
+    for (size_t i = 0; i < rt.size(); ++i) {
+      sum += rt[i];
+    }
+    printf(" %7.0f %7u %7u %7u", sum / rt.size(), rt[rt.size() / 2], rt[rt.size() * 95 / 100], rt.back());
+  }
+  for (int hop = 0; hop < 2; ++hop) {
+    if (b.snr_count[hop] > 0) {
+      printf(" %5.1f", (double)b.snr_sum[hop] / b.snr_count[hop]);
+    } else {
+      printf(" %5s", "-");
+    }
+  }
+  putchar('\n');
+}
+
+int main(int argc, char **argv)
+{
+  uint64_t bucket_s = 60;
+  uint64_t from_s = 0;
+  uint64_t to_s = UINT64_MAX;
+  int opt;
+  while ((opt = getopt(argc, argv, "b:f:t:")) != -1) {
+    switch (opt) {
+    case 'b':
+      bucket_s = strtoull(optarg, NULL, 10);
+      break;
+    case 'f':
+      from_s = strtoull(optarg, NULL, 10);
+      break;
+    case 't':
+      to_s = strtoull(optarg, NULL, 10);
+      break;
+    default:
+      optind = argc + 1;
+      break;
+    }
+  }
+  if (optind + 1 != argc || bucket_s == 0) {
+    fprintf(stderr, "usage: %s [-b bucket seconds] [-f from] [-t to] <log dir>\n", argv[0]);
+    return 2;
+  }
+
+  rn_column_log log;
+  if (!rn_column_log_open(&log, argv[optind], false)) {
+    perror(argv[optind]);
+    return 1;
+  }
+  const uint64_t *host_ns = (const uint64_t *)rn_column_log_column(&log, RN_COL_HOST_NS);
+  const uint32_t *seq = (const uint32_t *)rn_column_log_column(&log, RN_COL_SEQ);
+  const uint32_t *round_trip = (const uint32_t *)rn_column_log_column(&log, RN_COL_ROUND_TRIP);
+  const int8_t *snr[2] = {
+    (const int8_t *)rn_column_log_column(&log, RN_COL_HOP1_SNR),
+    (const int8_t *)rn_column_log_column(&log, RN_COL_HOP2_SNR),
+  };
+
+  printf("%-19s %7s %6s %7s %7s %7s %7s %7s %5s %5s\n",
+         "bucket", "packets", "lost", "loss", "rt", "rt p50", "rt p95", "rt max", "snr1", "snr2");
+
+  bucket current = bucket();
+  bool open_bucket = false;
+  bool have_previous = false;
+  uint32_t previous = 0;
+  for (uint64_t row = 0; row < log.rows; ++row) {
+    uint64_t second = host_ns[row] / 1000000000ULL;
+    if (second < from_s || second >= to_s) {
+      continue;
+    }
+
+    uint64_t start = second - second % bucket_s;
+    if (!open_bucket || start != current.start_s) {
+      if (open_bucket) {
+        print_bucket(current);
+      }
+      current = bucket();
+      current.start_s = start;
+      open_bucket = true;
+    }
+
+    ++current.packets;
+    if (have_previous && seq[row] > previous) {
+      current.lost += seq[row] - previous - 1;
+    }
+    previous = seq[row];
+    have_previous = true;
+
+    if (round_trip[row] > 0) {
+      current.round_trips.push_back(round_trip[row]);
+    }
+    for (int hop = 0; hop < 2; ++hop) {
+      if (snr[hop][row] != RN_LOG_NO_SNR) {
+        current.snr_sum[hop] += snr[hop][row];
+        ++current.snr_count[hop];
+      }
+    }
+  }
+  if (open_bucket) {
+    print_bucket(current);
+  }
+
+  rn_column_log_close(&log);
+  return 0;
+}
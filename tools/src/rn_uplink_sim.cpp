@@ -0,0 +1,128 @@
+/*
+ * Stands in for the receiver on a pseudo terminal, to run rn_gateway
+ * without radios.
+ *
+ *   rn_uplink_sim [-r packets per second] [-l loss percent] [-c count]
+ *
+ * Prints the pty's path, then writes uplink records for "P/<seq>" packets
+ * the way RN2483Receive does, with the drone's "BS:" and the transmitter's
+ * "RT:" fields, drifting SNRs and the given share of packets lost on the
+ * way, mixed with the debug text the real node prints. Runs until count
+ * packets (all of them lost or not) are done, forever by default.
+ */
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "rn_uplink.h"
+
+static bool write_all(int fd, const void *data, size_t len)
+{
+  const uint8_t *bytes = (const uint8_t *)data;
+  while (len > 0) {
+    ssize_t written = write(fd, bytes, len);
+    if (written <= 0) {
+      return false;
+    }
+    bytes += written;
+    len -= written;
+  }
+  return true;
+}
+
+static int drift(int value, int low, int high)
+{
+  value += rand() % 3 - 1;
+  return value < low ? low : value > high ? high : value;
+}
+
+int main(int argc, char **argv)
+{
+  double rate = 10;
+  int loss = 5;
+  unsigned long count = 0;
+  int opt;
+  while ((opt = getopt(argc, argv, "r:l:c:")) != -1) {
+    switch (opt) {
+    case 'r':
+      rate = atof(optarg);
+      break;
+    case 'l':
+      loss = atoi(optarg);
+      break;
+    case 'c':
+      count = strtoul(optarg, NULL, 10);
+      break;
+    default:
+      optind = argc + 1;
+      break;
+    }
+  }
+  if (optind != argc || rate <= 0 || loss < 0 || loss > 100) {
+    fprintf(stderr, "usage: %s [-r packets per second] [-l loss percent] [-c count]\n", argv[0]);
+    return 2;
+  }
+
+  int master = posix_openpt(O_RDWR | O_NOCTTY);
+  if (master < 0 || grantpt(master) != 0 || unlockpt(master) != 0) {
+    perror("posix_openpt");
+    return 1;
+  }
+  // Keep the slave open and raw, so nothing is mangled or lost before the gateway opens it
+  int slave = open(ptsname(master), O_RDWR | O_NOCTTY);
+  struct termios tio;
+  if (slave < 0 || tcgetattr(slave, &tio) != 0) {
+    perror(ptsname(master));
+    return 1;
+  }
+  cfmakeraw(&tio);
+  tcsetattr(slave, TCSANOW, &tio);
+  printf("%s\n", ptsname(master));
+  fflush(stdout);
+
+  srand((unsigned)time(NULL));
+  struct timespec pause;
+  pause.tv_sec = (time_t)(1 / rate);
+  pause.tv_nsec = (long)((1 / rate - pause.tv_sec) * 1e9);
+
+  rn_uplink_record record;
+  uint8_t frame[RN_UPLINK_FRAME_MAX];
+  int hop1 = 7;
+  int hop2 = 5;
+  uint32_t millis = 0;
+  for (unsigned long seq = 1; count == 0 || seq <= count; ++seq) {
+    nanosleep(&pause, NULL);
+    millis += (uint32_t)(1000 / rate);
+    hop1 = drift(hop1, -20, 12);
+    hop2 = drift(hop2, -20, 12);
+    if (rand() % 100 < loss) {
+      continue;
+    }
+
+    char text[96];
+    int len = snprintf(text, sizeof(text), "Sending message: P/%lu\r\nradio rx 0: ok\r\n", seq);
+    if (!write_all(master, text, len)) {
+      break;
+    }
+
+    len = snprintf((char *)record.payload, sizeof(record.payload), "P/%lu,RT:%d,FT:1.0.0.0.0.0.5,BS:%d,FD:1.0.0.0.0.0.5",
+                   seq, 4800 + rand() % 800, hop1);
+    record.millis = millis;
+    record.snr = (int8_t)hop2;
+    record.channel = 5;
+    record.length = (uint8_t)len;
+    if (!write_all(master, frame, rn_uplink_encode(&record, frame))) {
+      break;
+    }
+  }
+
+  // Closing the master drops what the gateway has not read yet
+  sleep(1);
+  close(slave);
+  close(master);
+  return 0;
+}
@@ -0,0 +1,56 @@
+/*
+ * Host stand-in for the Arduino core, just enough of it for the node
+ * library and the role sketches to build with -DARDUINO on Linux. The
+ * definitions in arduino.cpp run the roles against a simulated clock and
+ * RN2483, see rn_sim.h.
+ */
+#ifndef ARDUINO_H
+#define ARDUINO_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "WString.h"
+
+#define HIGH   1
+#define LOW    0
+#define OUTPUT 1
+#define A0     14
+
+typedef bool boolean;
+
+unsigned long millis();
+void delay(unsigned long ms);
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t value);
+int analogRead(uint8_t pin);
+long random(long low, long high);
+void randomSeed(unsigned long seed);
+
+class Stream {
+public:
+  void begin(unsigned long baud);
+  int available();
+  int read();
+  size_t write(uint8_t byte);
+  size_t write(const uint8_t *data, size_t len);
+  size_t print(const String &text);
+  size_t print(const __FlashStringHelper *text);
+  size_t println(const String &text);
+  size_t println(const __FlashStringHelper *text);
+  size_t println(const char *text);
+  size_t println();
+  void flush();
+  size_t readBytesUntil(char terminator, char *buffer, size_t len);
+  bool find(char *target);
+  String readStringUntil(char terminator);
+};
+
+class HardwareSerial : public Stream {
+};
+
+extern HardwareSerial Serial;
+
+#endif
@@ -0,0 +1,24 @@
+// Host stand-in for SoftwareSerial, the port the RN2483 hangs off
+#ifndef SOFTWARESERIAL_H
+#define SOFTWARESERIAL_H
+
+#include "Arduino.h"
+
+// Talks to the simulated module instead of the monitor, see rn_sim.h
+class SoftwareSerial : public Stream {
+public:
+  SoftwareSerial(uint8_t rx_pin, uint8_t tx_pin);
+
+  void begin(unsigned long baud);
+  int available();
+  int read();
+  size_t write(uint8_t byte);
+  size_t println(const char *text);
+  size_t println();
+  void flush();
+  size_t readBytesUntil(char terminator, char *buffer, size_t len);
+  bool find(char *target);
+  String readStringUntil(char terminator);
+};
+
+#endif
@@ -0,0 +1,65 @@
+/*
+ * Host stand-in for the Arduino String, on top of std::string, and for
+ * F(), which keeps the flash string type distinct so a String built from
+ * one still type-checks like on the board.
+ */
+#ifndef WSTRING_H
+#define WSTRING_H
+
+#include <stdint.h>
+#include <string.h>
+
+#include <string>
+
+class __FlashStringHelper;
+#define F(text) (reinterpret_cast<const __FlashStringHelper *>(text))
+
+class String {
+public:
+  String(const char *text = "") : s(text) {}
+  String(const __FlashStringHelper *text) : s(reinterpret_cast<const char *>(text)) {}
+  explicit String(char c) : s(1, c) {}
+  explicit String(unsigned char value) : s(std::to_string(value)) {}
+  explicit String(int value) : s(std::to_string(value)) {}
+  explicit String(unsigned int value) : s(std::to_string(value)) {}
+  explicit String(long value) : s(std::to_string(value)) {}
+  explicit String(unsigned long value) : s(std::to_string(value)) {}
+
+  unsigned int length() const { return (unsigned int)s.size(); }
+  const char *c_str() const { return s.c_str(); }
+  String &operator+=(const String &other) { s += other.s; return *this; }
+  bool operator==(const String &other) const { return s == other.s; }
+
+  std::string s;
+};
+
+// What "text" + String(...) and longer chains resolve to, as in the core
+class StringSumHelper : public String {
+public:
+  StringSumHelper(const String &text) : String(text) {}
+  StringSumHelper(const char *text) : String(text) {}
+  StringSumHelper(const __FlashStringHelper *text) : String(text) {}
+};
+
+inline StringSumHelper &operator+(const StringSumHelper &left, const String &right)
+{
+  StringSumHelper &sum = const_cast<StringSumHelper &>(left);
+  sum.s += right.s;
+  return sum;
+}
+
+inline StringSumHelper &operator+(const StringSumHelper &left, const char *right)
+{
+  StringSumHelper &sum = const_cast<StringSumHelper &>(left);
+  sum.s += right;
+  return sum;
+}
+
+inline StringSumHelper &operator+(const StringSumHelper &left, const __FlashStringHelper *right)
+{
+  StringSumHelper &sum = const_cast<StringSumHelper &>(left);
+  sum.s += reinterpret_cast<const char *>(right);
+  return sum;
+}
+
+#endif
@@ -0,0 +1,274 @@
+/*
+ * Definitions of the host stand-ins: a clock that only moves when the node
+ * waits, Serial into a log and an RN2483 that answers the commands
+ * rn_radio sends. See rn_sim.h.
+ */
+#include "Arduino.h"
+#include "EEPROM.h"
+#include "SoftwareSerial.h"
+#include "avr/wdt.h"
+#include "rn2xx3.h"
+#include "rn_sim.h"
+
+#include <deque>
+
+#include "rn_channel.h"
+#include "rn_frame.h"
+#include "rn_txqueue.h"
+
+HardwareSerial Serial;
+EEPROMClass EEPROM;
+volatile uint8_t MCUSR;
+
+static unsigned long clock_ms;
+static std::deque<rn_sim_frame> air;   // to be heard, in order
+static std::vector<rn_sim_frame> sent;
+static std::string module_out;          // lines from the module not read yet
+static std::string serial_log;
+static uint8_t tuned = RN_CHANNEL_NONE;
+static unsigned long rx_wdt;            // "radio set wdt"
+static unsigned quiet;
+static unsigned quiet_limit;
+
+void rn_sim_reset(unsigned limit)
+{
+  air.clear();
+  sent.clear();
+  serial_log.clear();
+  quiet = 0;
+  quiet_limit = limit;
+}
+
+void rn_sim_hear(uint8_t channel, const std::string &payload)
+{
+  rn_sim_frame frame = {channel, payload};
+  air.push_back(frame);
+}
+
+const std::vector<rn_sim_frame> &rn_sim_sent()
+{
+  return sent;
+}
+
+uint8_t rn_sim_channel()
+{
+  return tuned;
+}
+
+const std::string &rn_sim_log()
+{
+  return serial_log;
+}
+
+unsigned long millis()
+{
+  return clock_ms;
+}
+
+void delay(unsigned long ms)
+{
+  clock_ms += ms;
+}
+
+void pinMode(uint8_t, uint8_t) {}
+void digitalWrite(uint8_t, uint8_t) {}
+int analogRead(uint8_t) { return 0; }
+long random(long low, long) { return low; }
+void randomSeed(unsigned long) {}
+
+void wdt_enable(uint8_t) {}
+void wdt_reset() {}
+void wdt_disable() {}
+
+// Serial, the monitor port
+
+void Stream::begin(unsigned long) {}
+int Stream::available() { return 0; }
+int Stream::read() { return -1; }
+void Stream::flush() {}
+size_t Stream::readBytesUntil(char, char *, size_t) { return 0; }
+bool Stream::find(char *) { return false; }
+String Stream::readStringUntil(char) { return ""; }
+
+size_t Stream::write(uint8_t byte)
+{
+  serial_log += (char)byte;
+  return 1;
+}
+
+size_t Stream::write(const uint8_t *data, size_t len)
+{
+  serial_log.append((const char *)data, len);
+  return len;
+}
+
+size_t Stream::print(const String &text)
+{
+  serial_log += text.s;
+  return text.length();
+}
+
+size_t Stream::print(const __FlashStringHelper *text)
+{
+  return print(String(text));
+}
+
+size_t Stream::println(const String &text)
+{
+  return print(text) + println();
+}
+
+size_t Stream::println(const __FlashStringHelper *text)
+{
+  return println(String(text));
+}
+
+size_t Stream::println(const char *text)
+{
+  return println(String(text));
+}
+
+size_t Stream::println()
+{
+  serial_log += "\r\n";
+  return 2;
+}
+
+// The module
+
+static void reply(const char *line)
+{
+  module_out += line;
+  module_out += "\r\n";
+}
+
+static bool starts_with(const std::string &text, const char *prefix)
+{
+  return text.compare(0, strlen(prefix), prefix) == 0;
+}
+
+// A receive window of ms, ends with the next frame queued for this channel or radio_err
+static void receive_window(unsigned long ms)
+{
+  if (!air.empty() && (air.front().channel == tuned || air.front().channel == RN_CHANNEL_NONE)) {
+    const std::string &payload = air.front().payload;
+    std::string hex(2 * payload.size(), '\0');
+    rn_hex_encode((const uint8_t *)payload.data(), payload.size(), &hex[0]);
+    clock_ms += rn_airtime(payload.size());
+    module_out += "radio_rx  " + hex + "\r\n";
+    air.pop_front();
+    quiet = 0;
+    return;
+  }
+  clock_ms += ms;
+  reply("radio_err");
+  if (++quiet > quiet_limit) {
+    throw rn_sim_end();
+  }
+}
+
+static void transmit(const std::string &hex)
+{
+  rn_sim_frame frame = {tuned, std::string(hex.size() / 2, '\0')};
+  if (hex.size() % 2 != 0 || !rn_hex_decode(hex.data(), hex.size(), (uint8_t *)&frame.payload[0])) {
+    reply("invalid_param");
+    return;
+  }
+  sent.push_back(frame);
+  reply("ok");
+  clock_ms += rn_airtime(frame.payload.size());
+  reply("radio_tx_ok");
+}
+
+static std::string command(const std::string &line)
+{
+  if (starts_with(line, "radio rx ")) {
+    unsigned long symbols = strtoul(line.c_str() + 9, NULL, 10);
+    // A symbol lasts 16.4 ms at SF12/250 kHz, 0 listens until the module's watchdog
+    receive_window(symbols == 0 ? rx_wdt : symbols * 164 / 10);
+  }
+  else if (starts_with(line, "radio set freq ")) {
+    unsigned long frequency = strtoul(line.c_str() + 15, NULL, 10);
+    for (uint8_t channel = 0; channel < RN_CHANNEL_COUNT; ++channel) {
+      if (rn_channel_frequency(channel) == frequency) {
+        tuned = channel;
+      }
+    }
+  }
+  else if (starts_with(line, "radio set wdt ")) {
+    rx_wdt = strtoul(line.c_str() + 14, NULL, 10);
+  }
+  return "ok";
+}
+
+SoftwareSerial::SoftwareSerial(uint8_t, uint8_t) {}
+void SoftwareSerial::begin(unsigned long) {}
+void SoftwareSerial::flush() {}
+int SoftwareSerial::available() { return (int)module_out.size(); }
+size_t SoftwareSerial::write(uint8_t) { return 1; }
+size_t SoftwareSerial::println() { return 2; }
+
+int SoftwareSerial::read()
+{
+  if (module_out.empty()) {
+    return -1;
+  }
+  int c = (uint8_t)module_out[0];
+  module_out.erase(0, 1);
+  return c;
+}
+
+size_t SoftwareSerial::println(const char *text)
+{
+  std::string line(text);
+  if (starts_with(line, "radio tx ")) {
+    transmit(line.substr(9));
+  }
+  else if (line == "sys get ver") {
+    reply("RN2483 1.0.5 Oct 31 2018 15:06:52");
+  }
+  else {
+    reply(command(line).c_str());
+  }
+  return line.size() + 2;
+}
+
+size_t SoftwareSerial::readBytesUntil(char terminator, char *buffer, size_t len)
+{
+  size_t end = module_out.find(terminator);
+  size_t take = end == std::string::npos ? module_out.size() : end;
+  take = take < len ? take : len;
+  memcpy(buffer, module_out.data(), take);
+  // The terminator goes with the line, a cut off line leaves the rest
+  module_out.erase(0, take < end || end == std::string::npos ? take : take + 1);
+  return take;
+}
+
+bool SoftwareSerial::find(char *target)
+{
+  size_t at = module_out.find(target);
+  if (at == std::string::npos) {
+    module_out.clear();
+    return false;
+  }
+  module_out.erase(0, at + strlen(target));
+  return true;
+}
+
+String SoftwareSerial::readStringUntil(char terminator)
+{
+  char line[256];
+  size_t len = readBytesUntil(terminator, line, sizeof(line) - 1);
+  line[len] = '\0';
+  return String(line);
+}
+
+rn2xx3::rn2xx3(Stream &) {}
+String rn2xx3::hweui() { return "0004A30B001A2B3C"; }
+String rn2xx3::sysver() { return "RN2483 1.0.5 Oct 31 2018 15:06:52"; }
+int rn2xx3::getSNR() { return 7; }
+
+String rn2xx3::sendRawCommand(String line)
+{
+  return String(command(line.s).c_str());
+}
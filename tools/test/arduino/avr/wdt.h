@@ -0,0 +1,22 @@
+// Host stand-in for avr-libc's watchdog and the reset cause register
+#ifndef AVR_WDT_H
+#define AVR_WDT_H
+
+#include <stdint.h>
+
+#define WDTO_15MS 0
+#define WDTO_8S   9
+
+#define PORF 0
+#define BORF 2
+#define WDRF 3
+
+#define _BV(bit) (1 << (bit))
+
+extern volatile uint8_t MCUSR;
+
+void wdt_enable(uint8_t timeout);
+void wdt_reset();
+void wdt_disable();
+
+#endif
@@ -0,0 +1,16 @@
+// Host stand-in for the parts of jpmeijers' rn2xx3 library the radio driver uses
+#ifndef RN2XX3_H
+#define RN2XX3_H
+
+#include "Arduino.h"
+
+class rn2xx3 {
+public:
+  rn2xx3(Stream &serial);
+  String hweui();
+  String sysver();
+  String sendRawCommand(String command);
+  int getSNR();
+};
+
+#endif
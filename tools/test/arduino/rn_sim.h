@@ -0,0 +1,45 @@
+/*
+ * The simulated RN2483 and clock behind the host stand-ins, for tests that
+ * run a role's setup() and loop().
+ *
+ * The module hears the frames a test queues with rn_sim_hear(), in order,
+ * each one only while tuned to its channel; a receive window without one
+ * ends in radio_err after the window's time. Everything the node sends is
+ * kept with the channel it went out on. millis() only moves when the node
+ * waits: delay(), receive windows and the airtime of each frame.
+ *
+ * random() returns its lower bound, so session ids the node picks are 1.
+ */
+#ifndef RN_SIM_H
+#define RN_SIM_H
+
+#include <stdint.h>
+
+#include <string>
+#include <vector>
+
+struct rn_sim_frame {
+  uint8_t channel;     // RN_CHANNEL_NONE when heard on any channel
+  std::string payload;
+};
+
+// Thrown from a receive window once more than the limit went by quiet in a row
+struct rn_sim_end {
+};
+
+// Forgets queued and sent frames and the log, at most quiet_limit quiet windows in a row
+void rn_sim_reset(unsigned quiet_limit);
+
+// The module hears payload the next time it listens on channel
+void rn_sim_hear(uint8_t channel, const std::string &payload);
+
+// Frames the node sent since the last reset
+const std::vector<rn_sim_frame> &rn_sim_sent();
+
+// Channel the module is tuned to
+uint8_t rn_sim_channel();
+
+// Everything the node printed on Serial since the last reset
+const std::string &rn_sim_log();
+
+#endif
@@ -0,0 +1,616 @@
+/*
+ * Fuzz and property test of everything in lib/RN2483Link that reads bytes
+ * from the UART or the air.
+ *
+ *   rn_fuzz [-n inputs] [-s seed] [corpus files...]
+ *
+ * Every input goes through each target:
+ *
+ *   line       rn_parse_line(), the input as one line from the module
+ *   message    rn_classify() and rn_field_uint() against a plain reference
+ *   session    rn_session_message() and rn_session_poll(), the input split
+ *              at '\n' into messages for an initiator and a responder
+ *   reassembly rn_reassembly_add(), the input split into fragment frames,
+ *              and the input as a message sent in fragments out of order
+ *   blob       rn_blob_*(), the input sent as a blob over a lossy link
+ *   uplink     rn_uplink_feed(), the input as the receiver's serial stream
+ *
+ * and the invariants below are checked after every call. The corpus files
+ * run first, then -n inputs (100000 by default) made from them by a seeded
+ * generator: mutated corpus entries, protocol tokens glued together and
+ * random bytes. A failed check prints the input in hex and aborts.
+ *
+ * Built with -DRN_LIBFUZZER and -fsanitize=fuzzer, main() is left out and
+ * libFuzzer drives LLVMFuzzerTestOneInput() instead.
+ */
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+
+#include <string>
+#include <vector>
+
+#include "rn_channel.h"
+#include "rn_fragment.h"
+#include "rn_frame.h"
+#include "rn_session.h"
+#include "rn_uplink.h"
+
+static const uint8_t *current_data;
+static size_t current_size;
+
+static void fail(const char *check, int line)
+{
+  fprintf(stderr, "rn_fuzz.cpp:%d: check failed: %s\ninput (%zu bytes):", line, check, current_size);
+  for (size_t i = 0; i < current_size; ++i) {
+    fprintf(stderr, "%s%02X", i % 32 == 0 ? "\n  " : "", current_data[i]);
+  }
+  fprintf(stderr, "\n");
+  abort();
+}
+
+#define CHECK(cond) do { if (!(cond)) fail(#cond, __LINE__); } while (0)
+
+// Splits data at sep, empty pieces included
+static std::vector<std::string> split(const uint8_t *data, size_t size, char sep)
+{
+  std::vector<std::string> pieces(1);
+  for (size_t i = 0; i < size; ++i) {
+    if (data[i] == (uint8_t)sep) {
+      pieces.push_back(std::string());
+    } else {
+      pieces.back() += (char)data[i];
+    }
+  }
+  return pieces;
+}
+
+static void check_line(const uint8_t *data, size_t size)
+{
+  // An exact size copy, so reading past the line trips ASan
+  std::vector<char> line(data, data + size);
+  static const size_t capacities[] = {0, 1, 5, RN_MAX_PAYLOAD};
+  for (size_t c = 0; c < sizeof(capacities) / sizeof(capacities[0]); ++c) {
+    size_t capacity = capacities[c];
+    std::vector<uint8_t> payload(capacity + 1);
+    size_t payload_len = 12345;
+    rn_line_type type = rn_parse_line(line.data(), size, payload.data(), capacity, &payload_len);
+    CHECK(type <= RN_LINE_OTHER);
+    CHECK(payload_len <= capacity);
+    CHECK(type == RN_LINE_RADIO_RX || payload_len == 0);
+    if (type != RN_LINE_RADIO_RX) {
+      continue;
+    }
+
+    // The payload encodes back to the hex at the end of the line
+    CHECK(payload_len > 0);
+    std::vector<char> hex(2 * payload_len + 1);
+    rn_hex_encode(payload.data(), payload_len, hex.data());
+    size_t end = size;
+    while (end > 0 && (data[end - 1] == ' ' || data[end - 1] == '\t'
+                       || data[end - 1] == '\r' || data[end - 1] == '\n')) {
+      --end;
+    }
+    CHECK(end >= 2 * payload_len);
+    CHECK(strncasecmp(line.data() + end - 2 * payload_len, hex.data(), 2 * payload_len) == 0);
+
+    // Decoding in place gives the same
+    std::vector<char> in_place(line);
+    size_t in_place_len = 0;
+    CHECK(rn_parse_line(in_place.data(), size, (uint8_t *)in_place.data(), capacity, &in_place_len) == type);
+    CHECK(in_place_len == payload_len);
+    CHECK(memcmp(in_place.data(), payload.data(), payload_len) == 0);
+  }
+}
+
+// What rn_classify() should say, written as plainly as possible
+static rn_msg_type classify_reference(const std::string &msg)
+{
+  if (msg.empty()) {
+    return RN_MSG_NONE;
+  }
+  size_t slash = msg.find('/');
+  std::string token = msg.substr(0, slash);
+  bool has_slash = slash != std::string::npos;
+  if (token == "CONNECT") return RN_MSG_CONNECT;
+  if (token == "CONNECTED") return RN_MSG_CONNECTED;
+  if (token == "RESUME") return RN_MSG_RESUME;
+  if (token == "RESUMED") return RN_MSG_RESUMED;
+  if (token == "REJECT") return RN_MSG_REJECT;
+  if (token == "HOP") return RN_MSG_HOP;
+  if (token == "DEFER") return RN_MSG_DEFER;
+  if (token == "START") return RN_MSG_START;
+  if (token == "END") return RN_MSG_END;
+  if (token == "F" && has_slash) return RN_MSG_FRAGMENT;
+  if (token == "A" && has_slash) return RN_MSG_FRAG_ACK;
+  if (token == "P" && has_slash && slash + 1 < msg.size() && isdigit((unsigned char)msg[slash + 1])) {
+    return RN_MSG_PACKET;
+  }
+  return RN_MSG_TEXT;
+}
+
+static bool field_reference(const std::string &msg, uint8_t index, uint32_t *value)
+{
+  std::vector<std::string> fields = split((const uint8_t *)msg.data(), msg.size(), '/');
+  if (index >= fields.size() || fields[index].empty() || !isdigit((unsigned char)fields[index][0])) {
+    return false;
+  }
+  unsigned long long result = 0;
+  for (size_t i = 0; i < fields[index].size() && isdigit((unsigned char)fields[index][i]); ++i) {
+    result = result * 10 + (fields[index][i] - '0');
+    if (result > 0xFFFFFFFFULL) {
+      return false;
+    }
+  }
+  *value = (uint32_t)result;
+  return true;
+}
+
+static void check_message(const uint8_t *data, size_t size)
+{
+  std::vector<uint8_t> msg(data, data + size);
+  std::string text(data, data + size);
+  CHECK(rn_classify(msg.data(), size) == classify_reference(text));
+  for (uint8_t index = 0; index < 5; ++index) {
+    uint32_t value = 0;
+    uint32_t expected = 0;
+    bool ok = rn_field_uint(msg.data(), size, index, &value);
+    CHECK(ok == field_reference(text, index, &expected));
+    CHECK(!ok || value == expected);
+  }
+}
+
+static const uint32_t session_timeouts[RN_SESSION_STATE_COUNT] = {
+  0,
+  RN_SESSION_CONNECT_TIMEOUT,
+  RN_SESSION_IDLE_TIMEOUT,
+  RN_SESSION_SUSPEND_TIMEOUT,
+  RN_SESSION_RESUME_TIMEOUT
+};
+
+// A session and when it entered its state, which resent requests must not move
+struct node {
+  rn_session s;
+  uint8_t state;
+  uint32_t entered;
+};
+
+static void check_session_state(node *n, uint32_t now)
+{
+  const rn_session *s = &n->s;
+  CHECK(s->state < RN_SESSION_STATE_COUNT);
+  CHECK((s->state == RN_SESSION_IDLE) == (s->id == 0));
+  CHECK(s->misses < RN_SESSION_MAX_MISSES);
+  CHECK(s->channel == RN_CHANNEL_NONE || s->channel < RN_CHANNEL_COUNT);
+  if (s->state != n->state) {
+    n->state = s->state;
+    n->entered = now;
+  }
+}
+
+// Formats what an action sends and checks it reads back as that message
+static std::string check_action(const rn_session *s, rn_session_action action)
+{
+  static const rn_msg_type types[] = {
+    RN_MSG_NONE, RN_MSG_CONNECT, RN_MSG_CONNECTED, RN_MSG_RESUME, RN_MSG_RESUMED, RN_MSG_REJECT
+  };
+  CHECK(action <= RN_ACT_SEND_REJECT);
+  char buf[48];
+  size_t len = rn_session_format(s, action, buf, sizeof(buf));
+  if (action == RN_ACT_NONE) {
+    CHECK(len == 0);
+    return std::string();
+  }
+  CHECK(len > 0 && len < sizeof(buf));
+  CHECK(rn_classify((const uint8_t *)buf, len) == types[action]);
+  uint32_t id = 0;
+  CHECK(rn_field_uint((const uint8_t *)buf, len, 1, &id));
+  CHECK(id == (action == RN_ACT_SEND_REJECT ? s->rejected : s->id));
+  CHECK(id != 0);
+  return std::string(buf, len);
+}
+
+/*
+ * Polls and checks that no state outlives its timeout, and that an attempt
+ * to connect or resume ends in time however often its request was resent
+ */
+static void poll_session(node *n, uint32_t now)
+{
+  check_action(&n->s, rn_session_poll(&n->s, now));
+  check_session_state(n, now);
+  uint32_t timeout = session_timeouts[n->s.state];
+  CHECK(timeout == 0 || now - n->s.since < timeout);
+  if (n->s.state == RN_SESSION_CONNECTING || n->s.state == RN_SESSION_RESUMING) {
+    CHECK(now - n->entered < timeout);
+  }
+}
+
+static std::string deliver(node *n, const std::string &msg, uint32_t now)
+{
+  std::string reply = check_action(&n->s, rn_session_message(&n->s, (const uint8_t *)msg.data(), msg.size(), now));
+  check_session_state(n, now);
+  return reply;
+}
+
+static std::string open_session(node *n, uint16_t id, uint32_t now)
+{
+  std::string reply = check_action(&n->s, rn_session_event(&n->s, RN_EV_OPEN, id, now));
+  check_session_state(n, now);
+  return reply;
+}
+
+static bool same_session(const node *a, const node *b)
+{
+  return rn_session_established(&a->s) && rn_session_established(&b->s) && a->s.id == b->s.id;
+}
+
+/*
+ * Runs the messages of the input past an initiator and a responder, as the
+ * transmitter and drone or the drone and receiver would. The first byte of
+ * each message picks the node, whether the initiator opens a session first,
+ * whether that request and the reply get lost and how many seconds pass.
+ * Replies go to the other node. Afterwards a few
+ * clean handshakes must get both into the same session, whatever the
+ * garbage left them in.
+ */
+static void check_session(const uint8_t *data, size_t size)
+{
+  uint32_t now = 0xFFFF0000UL; // millis() wraps around during the run
+  node initiator;
+  node responder;
+  rn_session_init(&initiator.s);
+  rn_session_init(&responder.s);
+  initiator.state = responder.state = RN_SESSION_IDLE;
+  initiator.entered = responder.entered = now;
+  uint16_t next_id = 1;
+
+  std::vector<std::string> messages = split(data, size, '\n');
+  for (size_t i = 0; i < messages.size(); ++i) {
+    uint8_t control = messages[i].empty() ? 0 : (uint8_t)messages[i][0];
+    std::string msg = messages[i].empty() ? messages[i] : messages[i].substr(1);
+    bool lost = (control & 0x20) != 0;
+    now += (control & 0x1F) * 8000UL;
+
+    if (control & 0x40) {
+      std::string request = open_session(&initiator, next_id++ | 1, now);
+      if (!request.empty() && !lost) {
+        deliver(&initiator, deliver(&responder, request, now), now);
+      }
+    }
+    node *to = (control & 0x80) ? &initiator : &responder;
+    node *other = to == &initiator ? &responder : &initiator;
+    std::string reply = deliver(to, msg, now);
+    if (!reply.empty() && !lost) {
+      deliver(to, deliver(other, reply, now), now);
+    }
+    poll_session(&initiator, now);
+    poll_session(&responder, now);
+  }
+
+  for (int round = 0; round < 4 && !same_session(&initiator, &responder); ++round) {
+    if (rn_session_established(&initiator.s)) {
+      // The responder lost the session, the initiator notices by its misses
+      for (int miss = 0; miss < RN_SESSION_MAX_MISSES; ++miss) {
+        deliver(&initiator, std::string(), now);
+      }
+    }
+    now += 1000;
+    std::string request = open_session(&initiator, next_id++ | 1, now);
+    CHECK(!request.empty());
+    std::string reply = deliver(&responder, request, now);
+    CHECK(!reply.empty());
+    CHECK(deliver(&initiator, reply, now).empty());
+  }
+  CHECK(same_session(&initiator, &responder));
+}
+
+static void check_reassembly_state(const rn_reassembly *r)
+{
+  CHECK(r->total <= RN_FRAG_MAX_FRAGMENTS);
+  CHECK((r->received & ~rn_frag_all(r->total)) == 0);
+  CHECK(r->length <= RN_FRAG_MAX_MESSAGE);
+  CHECK(r->total != 0 || r->received == 0);
+
+  uint8_t ack[RN_FRAG_ACK_LEN];
+  uint8_t id = 0;
+  uint16_t received = 0;
+  CHECK(rn_reassembly_ack(r, ack) == RN_FRAG_ACK_LEN);
+  CHECK(rn_frag_parse_ack(ack, sizeof(ack), &id, &received));
+  CHECK(id == r->id && received == r->received);
+}
+
+static void check_reassembly(const uint8_t *data, size_t size)
+{
+  // The input cut into frames, as noise or a broken sender would send them
+  rn_reassembly r;
+  rn_reassembly_init(&r);
+  uint32_t now = 0;
+  std::vector<std::string> frames = split(data, size, '\n');
+  for (size_t i = 0; i < frames.size(); ++i) {
+    std::vector<uint8_t> frame(frames[i].begin(), frames[i].end());
+    uint8_t id = r.id;
+    uint8_t total = r.total;
+    uint16_t received = r.received;
+    uint16_t length = r.length;
+    now += frame.empty() ? 0 : frame.back() * 1000UL;
+    rn_frag_result result = rn_reassembly_add(&r, frame.data(), frame.size(), now);
+    CHECK(result <= RN_FRAG_COMPLETE);
+    if (result == RN_FRAG_INVALID) {
+      CHECK(r.id == id && r.total == total && r.received == received && r.length == length);
+    }
+    CHECK((result == RN_FRAG_COMPLETE) <= rn_reassembly_complete(&r));
+    check_reassembly_state(&r);
+  }
+
+  // The input as a message, fragments in an order and with repeats picked by its bytes
+  size_t len = size < RN_FRAG_MAX_MESSAGE ? size : RN_FRAG_MAX_MESSAGE;
+  uint8_t total = rn_frag_count(len);
+  if (total == 0) {
+    return;
+  }
+  rn_reassembly_init(&r);
+  int completed = 0;
+  uint16_t sent = 0;
+  for (size_t i = 0; sent != rn_frag_all(total); ++i) {
+    uint8_t index = (uint8_t)((i < size ? data[i] : i) % total);
+    uint8_t frame[RN_FRAG_FRAME_MAX];
+    size_t frame_len = rn_frag_build(7, index, false, data, len, frame);
+    CHECK(frame_len > RN_FRAG_HEADER);
+    rn_frag_result result = rn_reassembly_add(&r, frame, frame_len, 0);
+    CHECK(result == ((sent & (1U << index)) ? RN_FRAG_DUPLICATE
+                     : (sent | (1U << index)) == rn_frag_all(total) ? RN_FRAG_COMPLETE : RN_FRAG_PARTIAL));
+    completed += result == RN_FRAG_COMPLETE;
+    sent |= (uint16_t)(1U << index);
+    check_reassembly_state(&r);
+  }
+  CHECK(completed == 1);
+  CHECK(r.length == len);
+  CHECK(memcmp(r.data, data, len) == 0);
+}
+
+/*
+ * Sends the input as a blob to a reassembly over a link that loses the
+ * frames and acks the input's bits pick, a quarter of them on average
+ */
+static void check_blob(const uint8_t *data, size_t size)
+{
+  size_t len = size < RN_FRAG_MAX_MESSAGE ? size : RN_FRAG_MAX_MESSAGE;
+  rn_blob_sender b;
+  if (!rn_blob_begin(&b, 9, len)) {
+    CHECK(rn_frag_count(len) == 0);
+    return;
+  }
+  uint8_t total = b.total;
+  rn_reassembly r;
+  rn_reassembly_init(&r);
+
+  size_t bit = 0;
+  int frames = 0;
+  bool answered = true;
+  rn_blob_result result = RN_BLOB_SENDING;
+  while (result == RN_BLOB_SENDING) {
+    CHECK(rn_blob_busy(&b));
+    uint8_t frame[RN_FRAG_FRAME_MAX];
+    size_t frame_len;
+    int round_frames = 0;
+    bool request_heard = false;
+    while ((frame_len = rn_blob_next(&b, data, len, frame)) > 0) {
+      CHECK(++frames <= RN_FRAG_MAX_ROUNDS * total);
+      ++round_frames;
+      bool lost = (data[(bit / 8) % size] >> (bit % 8) & 3) == 3;
+      bit += 2;
+      if (!lost) {
+        CHECK(rn_reassembly_add(&r, frame, frame_len, 0) != RN_FRAG_INVALID);
+        request_heard = rn_frag_ack_request(frame, frame_len);
+      }
+    }
+    // After a round without an ack only the request goes out again
+    CHECK(round_frames > 0 && (answered || round_frames == 1));
+
+    bool lost = (data[(bit / 8) % size] >> (bit % 8) & 3) == 3;
+    bit += 2;
+    if (request_heard && !lost) {
+      uint8_t ack[RN_FRAG_ACK_LEN];
+      result = rn_blob_ack(&b, ack, rn_reassembly_ack(&r, ack));
+      answered = true;
+    } else {
+      result = rn_blob_lost(&b);
+      answered = false;
+    }
+  }
+  CHECK(!rn_blob_busy(&b));
+  if (result == RN_BLOB_DONE) {
+    CHECK(rn_reassembly_complete(&r) && r.length == len);
+    CHECK(memcmp(r.data, data, len) == 0);
+  }
+}
+
+static void check_record(const rn_uplink_record *record)
+{
+  // What was decoded encodes and decodes to the same record
+  uint8_t frame[RN_UPLINK_FRAME_MAX];
+  size_t len = rn_uplink_encode(record, frame);
+  CHECK(len <= RN_UPLINK_FRAME_MAX);
+  CHECK(frame[0] == 0 && frame[len - 1] == 0 && memchr(frame + 1, 0, len - 2) == NULL);
+
+  rn_uplink_decoder decoder;
+  rn_uplink_decoder_init(&decoder);
+  rn_uplink_record decoded;
+  int records = 0;
+  for (size_t i = 0; i < len; ++i) {
+    records += rn_uplink_feed(&decoder, frame[i], &decoded);
+  }
+  CHECK(records == 1);
+  CHECK(decoded.millis == record->millis && decoded.snr == record->snr);
+  CHECK(decoded.channel == record->channel && decoded.length == record->length);
+  CHECK(memcmp(decoded.payload, record->payload, record->length) == 0);
+}
+
+static void check_uplink(const uint8_t *data, size_t size)
+{
+  rn_uplink_decoder decoder;
+  rn_uplink_decoder_init(&decoder);
+  rn_uplink_record record;
+  for (size_t i = 0; i < size; ++i) {
+    if (rn_uplink_feed(&decoder, data[i], &record)) {
+      check_record(&record);
+    }
+    CHECK(decoder.length <= sizeof(decoder.data));
+  }
+
+  // A record of the input's bytes, sent right after the input as garbage
+  memset(&record, 0, sizeof(record));
+  record.millis = size > 3 ? (uint32_t)data[0] << 24 | data[1] << 16 | data[2] << 8 | data[3] : 0;
+  record.snr = size > 4 ? (int8_t)data[4] : 0;
+  record.channel = size > 5 ? data[5] : 0;
+  record.length = (uint8_t)(size < RN_MAX_PAYLOAD ? size : RN_MAX_PAYLOAD);
+  if (record.length > 0) {
+    memcpy(record.payload, data, record.length);
+  }
+  check_record(&record);
+
+  uint8_t frame[RN_UPLINK_FRAME_MAX];
+  size_t len = rn_uplink_encode(&record, frame);
+  rn_uplink_record decoded;
+  bool complete = false;
+  for (size_t i = 0; i < len; ++i) {
+    complete = rn_uplink_feed(&decoder, frame[i], &decoded);
+  }
+  CHECK(complete);
+  CHECK(decoded.length == record.length && memcmp(decoded.payload, record.payload, record.length) == 0);
+}
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
+{
+  current_data = data;
+  current_size = size;
+  check_line(data, size);
+  check_message(data, size);
+  check_session(data, size);
+  check_reassembly(data, size);
+  check_blob(data, size);
+  check_uplink(data, size);
+  return 0;
+}
+
+#ifndef RN_LIBFUZZER
+
+// xorshift32, the same inputs for the same seed on every host
+static uint32_t random_state;
+
+static uint32_t next_random()
+{
+  random_state ^= random_state << 13;
+  random_state ^= random_state >> 17;
+  random_state ^= random_state << 5;
+  return random_state;
+}
+
+static const char *const tokens[] = {
+  "radio_rx  ", "radio_tx_ok", "radio_err", "busy", "ok", "invalid_param", "\r\n", " ",
+  "CONNECT/", "CONNECTED/", "RESUME/", "RESUMED/", "REJECT/", "HOP/", "DEFER/", "START", "END",
+  "P/", "F/", "A/", "/", "0", "1", "4", "65535", "65536", "4294967296", ",BS:-3", "\n", "\0"
+};
+
+static std::vector<uint8_t> generate(const std::vector<std::vector<uint8_t> > &corpus)
+{
+  std::vector<uint8_t> input;
+  uint32_t kind = next_random() % 4;
+  if (kind == 0 && !corpus.empty()) {
+    // A corpus entry with a few bytes flipped, inserted or cut
+    input = corpus[next_random() % corpus.size()];
+    for (uint32_t edits = 1 + next_random() % 4; edits > 0; --edits) {
+      size_t at = input.empty() ? 0 : next_random() % input.size();
+      switch (next_random() % 3) {
+      case 0:
+        if (!input.empty()) input[at] ^= (uint8_t)(1 << next_random() % 8);
+        break;
+      case 1:
+        input.insert(input.begin() + at, (uint8_t)next_random());
+        break;
+      default:
+        if (!input.empty()) input.erase(input.begin() + at);
+        break;
+      }
+    }
+  } else if (kind == 1) {
+    // Protocol tokens and numbers glued together
+    for (uint32_t count = 1 + next_random() % 12; count > 0; --count) {
+      const char *token = tokens[next_random() % (sizeof(tokens) / sizeof(tokens[0]))];
+      input.insert(input.end(), token, token + (*token ? strlen(token) : 1));
+      if (next_random() % 3 == 0) {
+        char number[12];
+        int len = snprintf(number, sizeof(number), "%u", next_random() % 70000);
+        input.insert(input.end(), number, number + len);
+      }
+    }
+  } else if (kind == 2) {
+    // Well formed hex after "radio_rx", in either case
+    const char *prefix = "radio_rx  ";
+    input.assign(prefix, prefix + strlen(prefix));
+    for (uint32_t digits = 2 * (next_random() % 300); digits > 0; --digits) {
+      input.push_back((uint8_t)"0123456789ABCDEFabcdef"[next_random() % 22]);
+    }
+  } else {
+    for (uint32_t len = next_random() % 600; len > 0; --len) {
+      input.push_back((uint8_t)next_random());
+    }
+  }
+  return input;
+}
+
+static bool read_file(const char *path, std::vector<uint8_t> *data)
+{
+  FILE *file = fopen(path, "rb");
+  if (file == NULL) {
+    return false;
+  }
+  int c;
+  while ((c = fgetc(file)) != EOF) {
+    data->push_back((uint8_t)c);
+  }
+  fclose(file);
+  return true;
+}
+
+int main(int argc, char **argv)
+{
+  unsigned long inputs = 100000;
+  random_state = 1;
+  int arg = 1;
+  for (; arg + 1 < argc && argv[arg][0] == '-'; arg += 2) {
+    if (strcmp(argv[arg], "-n") == 0) {
+      inputs = strtoul(argv[arg + 1], NULL, 10);
+    } else if (strcmp(argv[arg], "-s") == 0) {
+      random_state = (uint32_t)strtoul(argv[arg + 1], NULL, 10);
+    } else {
+      break;
+    }
+  }
+  if ((arg < argc && argv[arg][0] == '-') || random_state == 0) {
+    fprintf(stderr, "usage: %s [-n inputs] [-s seed] [corpus files...]\n", argv[0]);
+    return 2;
+  }
+
+  std::vector<std::vector<uint8_t> > corpus;
+  for (; arg < argc; ++arg) {
+    std::vector<uint8_t> data;
+    if (!read_file(argv[arg], &data)) {
+      perror(argv[arg]);
+      return 1;
+    }
+    LLVMFuzzerTestOneInput(data.data(), data.size());
+    corpus.push_back(data);
+  }
+
+  for (unsigned long i = 0; i < inputs; ++i) {
+    std::vector<uint8_t> input = generate(corpus);
+    LLVMFuzzerTestOneInput(input.data(), input.size());
+  }
+  printf("%zu corpus files and %lu generated inputs passed\n", corpus.size(), inputs);
+  return 0;
+}
+
+#endif
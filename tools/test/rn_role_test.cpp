@@ -0,0 +1,284 @@
+/*
+ * Tests of the role logic: each role's setup() and loop() run against the
+ * simulated RN2483 in test/arduino. The frames a role hears are queued up
+ * front and what it sent is checked afterwards. Built once per role with
+ * the flags of its platformio.ini, so only that role's tests are compiled
+ * in. Prints each failed check and exits non-zero.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <string>
+
+#include "rn_sim.h"
+#include "rn_channel.h"
+#include "rn_session.h"
+#include "rn_txqueue.h"
+
+#if defined(NODE_ROLE_TRANSMITTER)
+#include "rn_transmitter.h"
+#elif defined(NODE_ROLE_RELAY)
+#include "rn_relay.h"
+#elif defined(NODE_ROLE_RECEIVER)
+#include "rn_receiver.h"
+#endif
+
+static int failures;
+
+#define CHECK(cond) do { if (!(cond)) { printf("rn_role_test.cpp:%d: %s\n", __LINE__, #cond); ++failures; } } while (0)
+
+// Runs passes of the role's loop, fewer if the simulation runs out of frames to hear
+template <class Role>
+static void run(Role *node, int passes)
+{
+  try {
+    for (int pass = 0; pass < passes; ++pass) {
+      node->loop();
+    }
+  }
+  catch (const rn_sim_end &) {
+  }
+}
+
+// Payloads sent on channel since the last reset, joined by spaces
+static std::string sent_on(uint8_t channel)
+{
+  std::string joined;
+  for (size_t i = 0; i < rn_sim_sent().size(); ++i) {
+    if (rn_sim_sent()[i].channel == channel) {
+      joined += (joined.empty() ? "" : " ") + rn_sim_sent()[i].payload;
+    }
+  }
+  return joined;
+}
+
+static bool starts_with(const std::string &text, const std::string &prefix)
+{
+  return text.compare(0, prefix.size(), prefix) == 0;
+}
+
+#if defined(NODE_ROLE_TRANSMITTER)
+
+static bool logged(const char *text)
+{
+  return rn_sim_log().find(text) != std::string::npos;
+}
+
+// The drone as the transmitter sees it: session 1 on channel 3
+static const uint8_t hop = 3;
+
+static void connect(Transmitter *node)
+{
+  rn_sim_reset(2);
+  rn_sim_hear(RN_CHANNEL_UPLINK_RENDEZVOUS, "CONNECTED/1/3");
+  rn_sim_hear(hop, "P/1,RT:0,BS:7,FR:0");
+  run(node, 1);
+  CHECK(sent_on(RN_CHANNEL_UPLINK_RENDEZVOUS) == "CONNECT/1");
+  CHECK(starts_with(sent_on(hop), "START P/1,RT:0,FT:"));
+  CHECK(logged("Succesfully send"));
+}
+
+static void test_stale_confirmation(Transmitter *node)
+{
+  // A late confirmation of the burst before is no confirmation of this one
+  rn_sim_reset(2);
+  rn_sim_hear(hop, "P/1,RT:0,BS:7,FR:0");
+  run(node, 1);
+  CHECK(starts_with(sent_on(hop), "START P/2,"));
+  CHECK(logged("Failed to get confirmation"));
+  CHECK(!logged("Succesfully send"));
+}
+
+static void test_hop(Transmitter *node)
+{
+  // The drone moves the hop ahead of the confirmation, the next burst follows it
+  rn_sim_reset(2);
+  rn_sim_hear(hop, "HOP/1/6");
+  rn_sim_hear(hop, "P/3,RT:0,BS:7,FR:0");
+  run(node, 1);
+  CHECK(logged("Succesfully send"));
+  rn_sim_reset(0);
+  run(node, 1);
+  CHECK(sent_on(hop) == "");
+  CHECK(starts_with(sent_on(6), "START P/4,"));
+}
+
+static void test_defer(Transmitter *node)
+{
+  // A DEFER is waited out, and the burst goes again under the same number
+  rn_sim_reset(2);
+  rn_sim_hear(6, "DEFER/42");
+  rn_sim_hear(6, "P/5,RT:0,BS:7,FR:0");
+  unsigned long before = millis();
+  run(node, 2);
+  CHECK(millis() - before >= 42000UL);
+  CHECK(starts_with(sent_on(6), "START P/5,"));
+  CHECK(sent_on(6).find("P/5,", 10) != std::string::npos);
+  CHECK(logged("Succesfully send"));
+}
+
+static void run_tests()
+{
+  Transmitter node;
+  rn_sim_reset(0);
+  node.setup();
+  connect(&node);
+  test_stale_confirmation(&node);
+  test_hop(&node);
+  test_defer(&node);
+}
+
+#elif defined(NODE_ROLE_RELAY)
+
+// With a clean scan the receiver's hop goes on channel 0 and the transmitter's on 1
+static const uint8_t down = 0;
+static const uint8_t up = 1;
+
+static void connect(Relay *node)
+{
+  rn_sim_reset(RN_CHANNEL_COUNT * RN_CHANNEL_SCAN_SAMPLES);
+  node->setup();
+  rn_sim_reset(1);
+  rn_sim_hear(RN_CHANNEL_UPLINK_RENDEZVOUS, "CONNECT/9");
+  rn_sim_hear(RN_CHANNEL_DOWNLINK_RENDEZVOUS, "CONNECTED/1/0");
+  run(node, 1);
+  CHECK(sent_on(RN_CHANNEL_DOWNLINK_RENDEZVOUS) == "CONNECT/1/0");
+  CHECK(sent_on(RN_CHANNEL_UPLINK_RENDEZVOUS) == "CONNECTED/9/1");
+}
+
+// The transmitter's burst number seq, and the receiver's confirmation of it
+static void burst(uint32_t seq, bool confirmed)
+{
+  std::string packet = "P/" + std::to_string(seq) + ",RT:0,FT:1.0.0.0.0.0.0";
+  rn_sim_hear(up, "START");
+  rn_sim_hear(up, packet);
+  rn_sim_hear(up, "END");
+  if (confirmed) {
+    rn_sim_hear(down, packet + ",BS:7,FR:1.0.0.0.0.0.0");
+  }
+}
+
+static void test_forward(Relay *node)
+{
+  rn_sim_reset(1);
+  burst(1, true);
+  run(node, 1);
+  CHECK(sent_on(down) == "START P/1,RT:0,FT:1.0.0.0.0.0.0,BS:7,FD:1.0.0.0.0.0.0 END");
+  CHECK(sent_on(up) == "P/1,RT:0,FT:1.0.0.0.0.0.0,BS:7,FR:1.0.0.0.0.0.0");
+}
+
+static void test_quiet_transmitter(Relay *node)
+{
+  // Minutes without a burst are the transmitter waiting for its budget, no lost session
+  rn_sim_reset(RN_SESSION_MAX_MISSES + 3);
+  run(node, RN_SESSION_MAX_MISSES + 3);
+  CHECK(rn_sim_channel() == up);
+  rn_sim_reset(1);
+  burst(2, true);
+  run(node, 1);
+  CHECK(starts_with(sent_on(down), "START P/2,"));
+  CHECK(starts_with(sent_on(up), "P/2,"));
+}
+
+static void test_defer(Relay *node)
+{
+  // Bursts until the drone's budget runs out, then it answers DEFER instead
+  std::string deferred;
+  for (uint32_t seq = 3; seq < 40 && deferred.empty(); ++seq) {
+    rn_sim_reset(1);
+    burst(seq, true);
+    run(node, 1);
+    if (starts_with(sent_on(up), "DEFER/")) {
+      deferred = sent_on(up);
+      CHECK(sent_on(down) == "");
+    }
+  }
+  CHECK(!deferred.empty());
+  unsigned long seconds = strtoul(deferred.c_str() + 6, NULL, 10);
+  CHECK(seconds > 0 && seconds * 1000UL * RN_TXQ_DUTY_PERMILLE <= RN_TXQ_BUDGET * 1000UL);
+
+  // The transmitter waits the DEFER out without the drone giving up on it
+  rn_sim_reset(RN_SESSION_MAX_MISSES + 3);
+  run(node, RN_SESSION_MAX_MISSES + 3);
+  CHECK(rn_sim_channel() == up);
+}
+
+static void run_tests()
+{
+  Relay node;
+  connect(&node);
+  test_forward(&node);
+  test_quiet_transmitter(&node);
+  test_defer(&node);
+}
+
+#elif defined(NODE_ROLE_RECEIVER)
+
+// The drone moves the receiver's hop to channel 2
+static const uint8_t hop = 2;
+
+static void connect(Receiver *node)
+{
+  rn_sim_reset(0);
+  node->setup();
+  rn_sim_hear(RN_CHANNEL_DOWNLINK_RENDEZVOUS, "CONNECT/7/2");
+  run(node, 1);
+  CHECK(sent_on(RN_CHANNEL_DOWNLINK_RENDEZVOUS) == "CONNECTED/7/2");
+}
+
+static void test_confirmation(Receiver *node)
+{
+  rn_sim_reset(1);
+  rn_sim_hear(hop, "START");
+  rn_sim_hear(hop, "P/1,RT:0,FT:1.0.0.0.0.0.0,BS:7,FD:1.0.0.0.0.0.0");
+  rn_sim_hear(hop, "END");
+  run(node, 1);
+  CHECK(sent_on(hop) == "P/1,RT:0,FT:1.0.0.0.0.0.0,BS:7,FD:1.0.0.0.0.0.0,BS:7,FR:1.0.0.0.0.0.0");
+}
+
+static void test_broken_burst(Receiver *node)
+{
+  // A burst that breaks off is not confirmed
+  rn_sim_reset(1);
+  rn_sim_hear(hop, "START");
+  rn_sim_hear(hop, "P/2,RT:0");
+  run(node, 1);
+  CHECK(sent_on(hop) == "");
+}
+
+static void test_quiet_drone(Receiver *node)
+{
+  // The drone is quiet for as long as its budget says, the session stays on the hop
+  rn_sim_reset(RN_SESSION_MAX_MISSES + 3);
+  run(node, RN_SESSION_MAX_MISSES + 3);
+  CHECK(rn_sim_channel() == hop);
+  rn_sim_reset(1);
+  rn_sim_hear(hop, "START");
+  rn_sim_hear(hop, "P/3,RT:0");
+  rn_sim_hear(hop, "END");
+  run(node, 1);
+  CHECK(starts_with(sent_on(hop), "P/3,RT:0,BS:7,FR:"));
+}
+
+static void run_tests()
+{
+  Receiver node;
+  connect(&node);
+  test_confirmation(&node);
+  test_broken_burst(&node);
+  test_quiet_drone(&node);
+}
+
+#endif
+
+int main()
+{
+  run_tests();
+  if (failures > 0) {
+    printf("%d checks failed\n", failures);
+    return 1;
+  }
+  printf("all checks passed\n");
+  return 0;
+}
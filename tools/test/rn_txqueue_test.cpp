@@ -0,0 +1,181 @@
+/*
+ * Tests of the transmit queue: class order, aging, time to live, eviction,
+ * the control reserve, refilling, the wait rn_txq_wait() reports and
+ * millis() wrapping around. Prints each failed check and exits non-zero.
+ */
+#include <stdio.h>
+#include <string.h>
+
+#include <string>
+
+#include "rn_txqueue.h"
+
+static int failures;
+
+#define CHECK(cond) do { if (!(cond)) { printf("rn_txqueue_test.cpp:%d: %s\n", __LINE__, #cond); ++failures; } } while (0)
+
+static bool push(rn_txqueue *q, rn_tx_class cls, const std::string &frame, uint32_t now)
+{
+  return rn_txq_push(q, cls, (const uint8_t *)frame.data(), frame.size(), now);
+}
+
+// Sends the frame the queue picks, "-" if it holds everything back
+static std::string pop(rn_txqueue *q, uint32_t now)
+{
+  int index = rn_txq_next(q, now);
+  if (index < 0) {
+    return "-";
+  }
+  size_t len = 0;
+  const uint8_t *frame = rn_txq_frame(q, (uint8_t)index, &len);
+  std::string sent((const char *)frame, len);
+  rn_txq_sent(q, (uint8_t)index, now);
+  return sent;
+}
+
+static void test_airtime()
+{
+  // SF12, 250 kHz, CR 4/8, explicit header and CRC
+  CHECK(rn_airtime(5) == 463);
+  CHECK(rn_airtime(60) == 1905);
+  CHECK(rn_airtime(255) == 7017);
+  CHECK(rn_airtime(61) >= rn_airtime(60));
+}
+
+static void test_class_order()
+{
+  rn_txqueue q;
+  rn_txq_init(&q, 0);
+  push(&q, RN_TX_BULK, "F/1", 0);
+  push(&q, RN_TX_TELEMETRY, "START", 1);
+  push(&q, RN_TX_BULK, "F/2", 2);
+  push(&q, RN_TX_CONTROL, "CONNECT/5", 3);
+  CHECK(pop(&q, 10) == "CONNECT/5");
+  CHECK(pop(&q, 10) == "START");
+  CHECK(pop(&q, 10) == "F/1");
+  CHECK(pop(&q, 10) == "F/2");
+  CHECK(pop(&q, 10) == "-");
+  CHECK(q.sent[RN_TX_CONTROL] == 1 && q.sent[RN_TX_TELEMETRY] == 1 && q.sent[RN_TX_BULK] == 2);
+}
+
+static void test_control_overtakes_blob()
+{
+  // A blob queued fragment by fragment: an ack queued between two fragments goes first
+  rn_txqueue q;
+  rn_txq_init(&q, 0);
+  std::string fragment(53, 'F');
+  push(&q, RN_TX_BULK, fragment, 0);
+  push(&q, RN_TX_CONTROL, "A/12", 100);
+  CHECK(pop(&q, 200) == "A/12");
+  CHECK(pop(&q, 200) == fragment);
+}
+
+static void test_aging()
+{
+  rn_txqueue q;
+  rn_txq_init(&q, 0);
+  push(&q, RN_TX_BULK, "F/old", 0);
+  push(&q, RN_TX_TELEMETRY, "P/1", RN_TXQ_AGING - 1000);
+  CHECK(pop(&q, RN_TXQ_AGING + 1000) == "F/old");
+  CHECK(pop(&q, RN_TXQ_AGING + 1000) == "P/1");
+
+  // Aged bulk never overtakes control
+  push(&q, RN_TX_BULK, "F/old", 0);
+  push(&q, RN_TX_CONTROL, "HOP/1/3", RN_TXQ_AGING);
+  CHECK(pop(&q, RN_TXQ_AGING + 1000) == "HOP/1/3");
+}
+
+static void test_time_to_live()
+{
+  rn_txqueue q;
+  rn_txq_init(&q, 0);
+  push(&q, RN_TX_BULK, "F/x", 0);
+  push(&q, RN_TX_TELEMETRY, "P/1", 0);
+  push(&q, RN_TX_CONTROL, "CONNECT/1", 0);
+  CHECK(pop(&q, RN_TXQ_BULK_TTL) == "CONNECT/1");
+  CHECK(pop(&q, RN_TXQ_TELEMETRY_TTL) == "-");
+  CHECK(q.dropped[RN_TX_BULK] == 1 && q.dropped[RN_TX_TELEMETRY] == 1);
+
+  // A confirmation held past the peer's receive window answers nothing
+  push(&q, RN_TX_CONTROL, "P/7,RT:0", 0);
+  CHECK(pop(&q, RN_TXQ_CONTROL_TTL - 1) == "P/7,RT:0");
+  push(&q, RN_TX_CONTROL, "P/8,RT:0", 0);
+  CHECK(pop(&q, RN_TXQ_CONTROL_TTL) == "-");
+  CHECK(q.dropped[RN_TX_CONTROL] == 1);
+}
+
+static void test_eviction()
+{
+  rn_txqueue q;
+  rn_txq_init(&q, 0);
+  std::string big(RN_TXQ_BYTES / 2, 'F');
+  CHECK(push(&q, RN_TX_BULK, big, 0));
+  CHECK(push(&q, RN_TX_BULK, big, 0));
+  CHECK(!push(&q, RN_TX_BULK, big, 0));
+  CHECK(push(&q, RN_TX_CONTROL, "CONNECTED/1", 1));
+  CHECK(q.count == 2 && q.dropped[RN_TX_BULK] == 1);
+  CHECK(pop(&q, 2) == "CONNECTED/1");
+
+  // Nothing but bulk is pushed out
+  rn_txq_init(&q, 0);
+  std::string full(RN_TXQ_BYTES < 0xFF ? RN_TXQ_BYTES : 0xFF, 'P');
+  CHECK(push(&q, RN_TX_TELEMETRY, full, 0));
+  CHECK(!push(&q, RN_TX_CONTROL, "CONNECT/1", 0));
+}
+
+static void test_budget()
+{
+  rn_txqueue q;
+  rn_txq_init(&q, 0);
+  std::string packet(60, 'P');
+  uint32_t now = 0;
+  int bursts = 0;
+  while (rn_txq_affordable(&q, RN_TX_TELEMETRY, rn_airtime(packet.size()), now)) {
+    push(&q, RN_TX_TELEMETRY, packet, now);
+    CHECK(pop(&q, now) == packet);
+    ++bursts;
+  }
+  CHECK(bursts == (int)((RN_TXQ_BUDGET - RN_TXQ_CONTROL_RESERVE) / rn_airtime(packet.size())));
+
+  // Telemetry stays out of the reserve, the largest control frame still goes
+  push(&q, RN_TX_TELEMETRY, packet, now);
+  CHECK(pop(&q, now) == "-");
+  rn_txq_drop(&q, RN_TX_TELEMETRY);
+  std::string confirmation(RN_TXQ_CONTROL_MAX, 'C');
+  CHECK(push(&q, RN_TX_CONTROL, confirmation, now));
+  CHECK(pop(&q, now) == confirmation);
+
+  // rn_txq_wait() says how long until the packet is affordable, and it is then
+  uint32_t wait = rn_txq_wait(&q, RN_TX_TELEMETRY, rn_airtime(packet.size()), now);
+  CHECK(wait > 0);
+  CHECK(!rn_txq_affordable(&q, RN_TX_TELEMETRY, rn_airtime(packet.size()), now + wait - 1));
+  CHECK(rn_txq_affordable(&q, RN_TX_TELEMETRY, rn_airtime(packet.size()), now + wait));
+  CHECK(rn_txq_wait(&q, RN_TX_TELEMETRY, rn_airtime(packet.size()), now + wait) == 0);
+}
+
+static void test_wraparound()
+{
+  rn_txqueue q;
+  rn_txq_init(&q, 0xFFFFFF00UL);
+  push(&q, RN_TX_BULK, "F/w", 0xFFFFFF00UL);
+  CHECK(pop(&q, 0x100) == "F/w");
+  CHECK(rn_txq_wait(&q, RN_TX_CONTROL, 5, 0x200) == 0);
+}
+
+int main()
+{
+  test_airtime();
+  test_class_order();
+  test_control_overtakes_blob();
+  test_aging();
+  test_time_to_live();
+  test_eviction();
+  test_budget();
+  test_wraparound();
+  if (failures > 0) {
+    printf("%d checks failed\n", failures);
+    return 1;
+  }
+  printf("all checks passed\n");
+  return 0;
+}